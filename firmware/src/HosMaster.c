@@ -22,6 +22,13 @@
  *
  * See "Bluetooth Qualification and Declaration Processes" for more details:
  *   https://www.bluetooth.org/en-us/test-qualification/qualification-overview
+ *
+ * NOTE: This file has been modified since the qualification: the report
+ * buffering while disconnected, the profile switch without waiting, the SPI
+ * tuning, the transport and power statistics, the key wake-up on suspend,
+ * the LED sequencer, the power governor, the mouse coalescing, and the USB
+ * mode start-up. A firmware built from it is not covered by the existing
+ * qualification and has to be requalified before it is released as such.
  */
 
 #include <xc.h>
@@ -29,6 +36,8 @@
 #include <pps.h>
 #include <usart.h>
 #include <spi.h>
+#include <timers.h>
+#include <stdio.h>
 #include <string.h>
 
 #ifdef ESRILLE_NEW_KEYBOARD     // for HID bootloader?
@@ -55,13 +64,53 @@
 #define ADVERTISING_SLOW_LED_ON_INTERVAL       100      // Slow advertizing
 #define ADVERTISING_SLOW_LED_OFF_INTERVAL      900      // Period 1 sec, duty cycle 10%
 #define BONDING_INTERVAL                       100      // Bonding
+#define DFU_INTERVAL                           500      // Waiting for the module
+
+#define LED_TICKS(msec)     ((uint8_t) ((msec) * WDT_FREQ / 1000u))
+
+static const LED_PATTERN advertisingDirectedPattern = {
+    LED_TICKS(ADVERTISING_DIRECTED_LED_ON_INTERVAL), LED_TICKS(ADVERTISING_DIRECTED_LED_OFF_INTERVAL)
+};
+static const LED_PATTERN advertisingWhitelistPattern = {
+    LED_TICKS(ADVERTISING_WHITELIST_LED_ON_INTERVAL), LED_TICKS(ADVERTISING_WHITELIST_LED_OFF_INTERVAL)
+};
+static const LED_PATTERN advertisingPattern = {
+    LED_TICKS(ADVERTISING_LED_ON_INTERVAL), LED_TICKS(ADVERTISING_LED_OFF_INTERVAL)
+};
+static const LED_PATTERN advertisingSlowPattern = {
+    LED_TICKS(ADVERTISING_SLOW_LED_ON_INTERVAL), LED_TICKS(ADVERTISING_SLOW_LED_OFF_INTERVAL)
+};
+static const LED_PATTERN bondingPattern = {
+    LED_TICKS(BONDING_INTERVAL), LED_TICKS(BONDING_INTERVAL)
+};
+static const LED_PATTERN dfuPattern = {
+    LED_TICKS(DFU_INTERVAL), LED_TICKS(DFU_INTERVAL)
+};
 
 #define CS_LAT      LATDbits.LATD5
 #define CS_TRIS     TRISDbits.TRISD5
 
+#ifdef HOS_SPI_HOOK
+#define CS_SELECT(cs)   HosSpiSelect(cs)
+#else
+#define CS_SELECT(cs)   (CS_LAT = (cs))
+#endif
+
 #define RETRY_MAX   5
 #define RETRY_WAIT  128 // [usec]
 
+#define XFER_GOOD   0
+#define XFER_BUSY   1   // HOS_DEF_CHARACTER
+#define XFER_BAD    2   // broken profile byte
+
+#define SPI_SETTINGS_SIZE   6
+#define SPI_SAFE            (SPI_SETTINGS_SIZE - 1)
+#define SPI_TUNED           0x80    // flag saved with the selected setting
+#define TUNE_TRIALS         32
+#define SPI_BAD_MAX         3       // consecutive bad frames before falling back
+
+#define TIMER0_USEC(t)      ((uint32_t) (t) * 256 * 4 / (_XTAL_FREQ / 1000000))   // T0_PS_1_256
+
 #define BATTERY_LEVELS_SIZE                     100     // from 2.00 (200) to 2.99 (299)
 #define BATTERY_LEVEL_MEAS_INTERVAL             (WDT_FREQ * HOS_BATTERY_LEVEL_MEAS_INTERVAL / 1000)
 
@@ -84,6 +133,29 @@ typedef struct Tsap {
 static Info     info;
 static Tsap     tsap;
 
+typedef struct SpiSetting {
+    uint8_t pr2;    // 0 for SPI_FOSC_64; otherwise SCK = Fosc / 4 / (pr2 + 1) / 2 using Timer2
+    uint8_t guard;  // [usec] from CS low to the first SCK
+} SpiSetting;
+
+// From the fastest to the original setting. nRF51 SPIS runs up to 2 MHz.
+static const SpiSetting spiSettings[SPI_SETTINGS_SIZE] = {
+    { 2, 4 },   // 2 MHz
+    { 2, 8 },
+    { 3, 4 },   // 1.5 MHz
+    { 3, 8 },
+    { 5, 8 },   // 1 MHz
+    { 0, 8 },   // 750 kHz
+};
+
+static uint8_t  spi = SPI_SAFE;
+static bool     tuned;
+static uint8_t  spi_bad;        // consecutive bad frames
+static bool     spi_fallback;   // to be saved from HosMainLoop()
+
+static HosStats stats;
+static HosPower power;
+
 #ifndef ESRILLE_NEW_KEYBOARD    // i.e. not for bootloader
 static uint16_t battery_voltage;
 static uint8_t  battery_level;
@@ -101,6 +173,9 @@ static const uint8_t battery_levels[BATTERY_LEVELS_SIZE] = {
     100, 100, 100, 100, 100, 100, 100, 100, 100, 100,
     100, 100, 100, 100, 100, 100, 100, 100, 100, 100,
 };
+
+static const HosPolicy policies[] = { HOS_GOVERNOR_CURVE };
+static const HosPolicy* policy = policies;
 #endif
 
 void HosInitialize(void)
@@ -125,61 +200,123 @@ void HosInitialize(void)
     PPSLock();
 
     memset(status, 0, sizeof status);
+#ifndef ESRILLE_NEW_KEYBOARD
+    // Use the module info saved last time until the module responds.
+    ReadNvramCommon(NVRAM_COMMON_HOS_INFO, &info, sizeof info);
+
+    uint8_t setting;
+    ReadNvramCommon(NVRAM_COMMON_HOS_SPI, &setting, 1);
+    if ((setting & SPI_TUNED) && (setting & ~SPI_TUNED) < SPI_SETTINGS_SIZE) {
+        spi = setting & ~SPI_TUNED;
+        tuned = true;
+    }
+#endif
 }
 
+#ifndef HOS_SPI_HOOK
 uint8_t HosXfer(uint8_t byte)
 {
     WriteSPI2(byte);
     return SSP2BUF;
 }
+#endif
+
+static void Count(uint16_t* counter)
+{
+    if (*counter != 0xffff)
+        ++*counter;
+}
 
 static int8_t CheckProfile(uint8_t profile)
 {
     return ((~profile >> 4) & 0x0f) == (profile & 0x0f);
 }
 
-int8_t HosReport(uint8_t type, uint8_t cmd, uint8_t len, const uint8_t* data)
+static void OpenHosSPI(void)
 {
-    uint8_t buffer[HOS_STATE_LAST + 1];
-    uint8_t state;
-    int8_t good = 0;
+    uint8_t pr2 = spiSettings[spi].pr2;
 
     CloseSPI2();
-    OpenSPI2(SPI_FOSC_64, MODE_00, SMPMID); // Use MODE_00 for SPI_MODE_0 of nRF51
+    if (pr2) {
+        PMDIS1bits.TMR2MD = 0;
+        T2CON = 0x04;   // Timer2 on with 1:1 prescaler and postscaler
+        PR2 = pr2;
+        OpenSPI2(SPI_FOSC_TMR2, MODE_00, SMPMID);
+    } else {
+        OpenSPI2(SPI_FOSC_64, MODE_00, SMPMID); // Use MODE_00 for SPI_MODE_0 of nRF51
+    }
+}
 
-    for (int8_t retry = 0; retry < RETRY_MAX; ++retry) {
-        state = 0;
+static void CloseHosSPI(void)
+{
+    CloseSPI2();
+    if (spiSettings[spi].pr2) {
+        // Timer2 is used only for the SPI clock.
+        T2CON = 0;
+        PMDIS1bits.TMR2MD = 1;
+    }
+}
+
+static uint8_t Transfer(uint8_t type, uint8_t cmd, uint8_t len, const uint8_t* data, uint8_t* buffer)
+{
+    uint8_t state = 0;
 
+    __delay_us(1);
+    CS_SELECT(0);
+    // Wait nRF51 SPIS for 7.1 [us]. Shorter guards are used only if
+    // HosTuneSPI() has found them reliable with this module.
+    for (uint8_t i = spiSettings[spi].guard; i; --i)
         __delay_us(1);
-        CS_LAT = 0;
-        __delay_us(8);  // Wait nRF51 SPIS for 7.1 [us].
-
-        buffer[state++] = HosXfer(type);
-        buffer[state++] = HosXfer(cmd);
-        buffer[state++] = HosXfer(len);
-        if (len == 0) {
-            buffer[state++] = HosXfer(HOS_CMD_NONE);  // Send a dummy command.
-        } else {
-            buffer[state++] = HosXfer(data[0]);
-            for (uint8_t i = 1; i < len; ++i) {
-                if (state <= HOS_STATE_LAST)
-                    buffer[state++] = HosXfer(data[i]);
-                else
-                    HosXfer(data[i]);
-            }
+
+    buffer[state++] = HosXfer(type);
+    buffer[state++] = HosXfer(cmd);
+    buffer[state++] = HosXfer(len);
+    if (len == 0) {
+        buffer[state++] = HosXfer(HOS_CMD_NONE);  // Send a dummy command.
+    } else {
+        buffer[state++] = HosXfer(data[0]);
+        for (uint8_t i = 1; i < len; ++i) {
+            if (state <= HOS_STATE_LAST)
+                buffer[state++] = HosXfer(data[i]);
+            else
+                HosXfer(data[i]);
         }
-        while (state <= HOS_STATE_LAST)
-            buffer[state++] = HosXfer(HOS_CMD_NONE);  // Send a dummy command.
+    }
+    while (state <= HOS_STATE_LAST)
+        buffer[state++] = HosXfer(HOS_CMD_NONE);  // Send a dummy command.
+
+    __delay_us(2);
+    CS_SELECT(1);
+
+    if (buffer[0] == HOS_DEF_CHARACTER)
+        return XFER_BUSY;
+    if (!CheckProfile(buffer[HOS_STATE_PROFILE]))
+        return XFER_BAD;
+    return XFER_GOOD;
+}
+
+int8_t HosReport(uint8_t type, uint8_t cmd, uint8_t len, const uint8_t* data)
+{
+    uint8_t buffer[HOS_STATE_LAST + 1];
+    uint8_t result = XFER_BUSY;
+    int8_t good = 0;
+    uint16_t start = ReadTimer0();
+
+    if (HOS_CMD_GET_STATUS <= cmd && cmd <= HOS_CMD_KEYBOARD_REPORT)
+        Count(&stats.xfers[cmd - HOS_CMD_GET_STATUS]);
 
-        __delay_us(2);
-        CS_LAT = 1;
+    OpenHosSPI();
 
-        if (buffer[0] == HOS_DEF_CHARACTER) {
+    for (int8_t retry = 0; retry < RETRY_MAX; ++retry) {
+        result = Transfer(type, cmd, len, data, buffer);
+
+        if (result == XFER_BUSY) {
+            Count(&stats.retries);
             __delay_us(RETRY_WAIT);
             continue;
         }
 
-        if (CheckProfile(buffer[HOS_STATE_PROFILE])) {
+        if (result == XFER_GOOD) {
             memmove(status, buffer, HOS_STATE_COMMON_LAST + 1);
             switch (status[HOS_STATE_TYPE]) {
             case HOS_TYPE_INFO:
@@ -195,10 +332,59 @@ int8_t HosReport(uint8_t type, uint8_t cmd, uint8_t len, const uint8_t* data)
         }
         break;
     }
-    CloseSPI2();
+    CloseHosSPI();
+    if (result == XFER_BAD) {
+        Count(&stats.bad);
+        if (spi != SPI_SAFE && SPI_BAD_MAX <= ++spi_bad) {
+            // Fall back to the original setting; HosMainLoop() saves it
+            // later rather than writing the flash in the middle of a report.
+            spi = SPI_SAFE;
+            spi_fallback = true;
+        }
+    } else if (result == XFER_GOOD) {
+        spi_bad = 0;
+    }
+    if (!good)
+        Count(&stats.failures);
+
+    uint16_t elapsed = ReadTimer0() - start;
+    power.spi += elapsed;
+    uint32_t usec = TIMER0_USEC(elapsed);
+    if (stats.worst < usec)
+        stats.worst = (0xffff < usec) ? 0xffff : usec;
     return good;
 }
 
+const HosStats* HosGetStats(void)
+{
+    return &stats;
+}
+
+const HosPower* HosGetPower(void)
+{
+    return &power;
+}
+
+void HosClearStats(void)
+{
+    memset(&stats, 0, sizeof stats);
+    memset(&power, 0, sizeof power);
+}
+
+void HosPrintStats(void)
+{
+#ifdef DEBUG
+    printf("HOS xfers");
+    for (uint8_t i = 0; i < sizeof stats.xfers / sizeof stats.xfers[0]; ++i)
+        printf(" %u", stats.xfers[i]);
+    printf(" retries %u bad %u failures %u worst %u us spi %u\r\n",
+           stats.retries, stats.bad, stats.failures, stats.worst, spi);
+    printf("PWR active %lu spi %lu [1/%u s] sleeping %lu suspended %lu led %lu %lu %lu [1/%u s]\r\n",
+           power.active, power.spi, HOS_TIMER0_FREQ, power.sleeping, power.suspended,
+           power.led[0], power.led[1], power.led[2], WDT_FREQ);
+#endif
+}
+
 int8_t HosGetStatus(uint8_t type)
 {
     return HosReport(type, HOS_CMD_GET_STATUS, 0, NULL);
@@ -219,6 +405,72 @@ int8_t HosSleep(uint8_t type)
 }
 
 #ifndef ESRILLE_NEW_KEYBOARD    // i.e. not for bootloader
+// Sweep the SPI settings from the fastest one and select the first one that
+// passes all TUNE_TRIALS. The probes are HOS_CMD_NONE frames, which the
+// module takes as no-ops, so that a garbled probe cannot be taken for another
+// command; each reply frame must match the reference frame taken with the
+// original setting byte for byte. Call this only while the module has just
+// been reset and has no link.
+void HosTuneSPI(void)
+{
+    uint8_t reference[HOS_STATE_LAST + 1];
+    uint8_t buffer[HOS_STATE_LAST + 1];
+    uint8_t selected = SPI_SAFE;
+
+    // Get the reference frame with the original setting.
+    spi = SPI_SAFE;
+    if (!HosGetStatus(HOS_TYPE_INFO))
+        return;
+    OpenHosSPI();
+    for (uint8_t i = 0;; ++i) {
+        if (Transfer(HOS_TYPE_INFO, HOS_CMD_NONE, 0, NULL, reference) == XFER_GOOD)
+            break;
+        if (RETRY_MAX <= i) {
+            CloseHosSPI();
+            return;
+        }
+        __delay_us(RETRY_WAIT);
+    }
+    CloseHosSPI();
+    if (reference[HOS_STATE_TYPE] != HOS_TYPE_INFO ||
+        memcmp(reference + HOS_STATE_REV_MAJOR, &info, sizeof info))
+        return;
+
+    for (uint8_t s = 0; s < SPI_SAFE; ++s) {
+        uint8_t busy = 0;
+        uint8_t bad = 0;
+
+        spi = s;
+        OpenHosSPI();
+        for (uint8_t i = 0; i < TUNE_TRIALS; ++i) {
+            CLRWDT();
+            switch (Transfer(HOS_TYPE_INFO, HOS_CMD_NONE, 0, NULL, buffer)) {
+            case XFER_BUSY:
+                ++busy;
+                __delay_us(RETRY_WAIT);
+                break;
+            case XFER_BAD:
+                ++bad;
+                break;
+            default:
+                if (memcmp(buffer, reference, sizeof reference))
+                    ++bad;
+                break;
+            }
+        }
+        CloseHosSPI();
+        if (!bad && busy <= TUNE_TRIALS / 8) {
+            selected = s;
+            break;
+        }
+    }
+
+    spi = selected;
+    tuned = true;
+    selected |= SPI_TUNED;
+    WriteNvramCommon(NVRAM_COMMON_HOS_SPI, &selected, 1);
+}
+
 uint16_t HosGetBatteryVoltage(void)
 {
     return battery_voltage;
@@ -238,11 +490,39 @@ uint8_t HosGetBatteryLevel(void)
     return level;
 }
 
+// Select the policy step for the battery level. Stepping back up to a
+// better step takes HOS_GOVERNOR_HYSTERESIS more so that the noise in the
+// voltage does not flip the policy.
+const HosPolicy* HosGovern(uint8_t level)
+{
+    const HosPolicy* p = policies;
+
+    for (uint8_t i = 1; i < sizeof policies / sizeof policies[0]; ++i) {
+        if (level <= policies[i].level)
+            p = &policies[i];
+    }
+    if (p < policy && level <= policy->level + HOS_GOVERNOR_HYSTERESIS)
+        p = policy;
+    if (p != policy) {
+        policy = p;
+        for (LED i = LED_D1; i <= LED_D3; ++i)
+            LED_SetLevel(i, policy->led);
+    }
+    return policy;
+}
+
+const HosPolicy* HosGetPolicy(void)
+{
+    return policy;
+}
+
 static uint8_t HosUpdateBatteryLevel(uint16_t tick)
 {
+    static uint16_t measured;
     int8_t good = 1;
 
-    if (!(tick % BATTERY_LEVEL_MEAS_INTERVAL)) {
+    if (BATTERY_LEVEL_MEAS_INTERVAL <= (uint16_t) (tick - measured)) {
+        measured = tick;
         uint16_t v = HOS_BATTERY_VOLTAGE_OFFSET + status[HOS_STATE_BATT];
         uint16_t diff = (battery_voltage < v) ? (v - battery_voltage) : (battery_voltage - v);
         if (50 < diff) {
@@ -256,6 +536,7 @@ static uint8_t HosUpdateBatteryLevel(uint16_t tick)
         uint8_t level = HosGetBatteryLevel();
         if (battery_level != level) {
             battery_level = level;
+            HosGovern(level);
             good = HosSetBatteryLevel(HOS_TYPE_DEFAULT, battery_level);
         }
     }
@@ -294,17 +575,11 @@ uint8_t HosGetLESC(void)
     return (status[HOS_STATE_INDICATE] & HOS_BLE_STATE_LESC) ? 1 : 0;
 }
 
-static int8_t inRange(uint16_t onInterval, uint16_t offInterval, uint16_t tick)
-{
-    uint16_t range = onInterval + offInterval;
-
-    tick *= (1000 / WDT_FREQ);  // tick to msec
-    tick %= range;
-    return tick < onInterval;
-}
-
-void HosUpdateLED(LED led, uint16_t tick)
+// Hands the blink pattern of the current state to the LED sequencer, which
+// keeps it running from LED_Tick() until the state changes.
+void HosUpdateLED(LED led)
 {
+    const LED_PATTERN* pattern;
     uint8_t indicate = HOS_BLE_STATE_IDLE;
 
     if (led != LED_NONE) {
@@ -313,43 +588,30 @@ void HosUpdateLED(LED led, uint16_t tick)
     switch (indicate) {
     case HOS_BLE_STATE_SCANNING:
     case HOS_BLE_STATE_ADVERTISING:
-        if (inRange(ADVERTISING_LED_ON_INTERVAL, ADVERTISING_LED_OFF_INTERVAL, tick))
-            LED_On(led);
-        else
-            LED_Off(led);
+        pattern = &advertisingPattern;
         break;
     case HOS_BLE_STATE_ADVERTISING_WHITELIST:
-        if (inRange(ADVERTISING_WHITELIST_LED_ON_INTERVAL, ADVERTISING_WHITELIST_LED_OFF_INTERVAL, tick))
-            LED_On(led);
-        else
-            LED_Off(led);
+        pattern = &advertisingWhitelistPattern;
         break;
     case HOS_BLE_STATE_ADVERTISING_SLOW:
-        if (inRange(ADVERTISING_SLOW_LED_ON_INTERVAL, ADVERTISING_SLOW_LED_OFF_INTERVAL, tick))
-            LED_On(led);
-        else
-            LED_Off(led);
+        pattern = &advertisingSlowPattern;
         break;
     case HOS_BLE_STATE_ADVERTISING_DIRECTED:
-        if (inRange(ADVERTISING_DIRECTED_LED_ON_INTERVAL, ADVERTISING_DIRECTED_LED_OFF_INTERVAL, tick))
-            LED_On(led);
-        else
-            LED_Off(led);
+        pattern = &advertisingDirectedPattern;
         break;
     case HOS_BLE_STATE_BONDING:
-        if (inRange(BONDING_INTERVAL, BONDING_INTERVAL, tick))
-            LED_On(led);
-        else
-            LED_Off(led);
+        pattern = &bondingPattern;
         break;
     case HOS_BLE_STATE_CONNECTED:
-        break;
+        return;
     default:
         LED_Off(LED_D1);
         LED_Off(LED_D2);
         LED_Off(LED_D3);
-        break;
+        return;
     }
+    for (LED i = LED_D1; i <= LED_D3; ++i)
+        LED_SetPattern(i, (i == led) ? pattern : NULL);
 }
 
 uint16_t HosGetTouch(void)
@@ -377,6 +639,20 @@ uint16_t HosGetRevision(void)
     return (info.revisionMajor << 8) | info.revisionMinor;
 }
 
+// Blink LED_D3 until the module responds, e.g., while it is being updated.
+static void WaitForModule(void)
+{
+    LED_SetPattern(LED_D3, &dfuPattern);
+    for (;;) {
+        Sleep();
+        Nop();
+        if (HosGetStatus(HOS_TYPE_INFO))
+            break;
+        LED_Tick();
+    }
+    LED_Off(LED_D3);
+}
+
 void HosCheckDFU(bool dfu)
 {
     // Enable watchdog timer
@@ -400,19 +676,18 @@ void HosCheckDFU(bool dfu)
     LED_Off(LED_D2);
     LED_Off(LED_D3);
 
-    if (dfu || !responded) {
-        for (uint16_t tick = 0;; ++tick) {
-            Sleep();
-            Nop();
-            if (HosGetStatus(HOS_TYPE_INFO))
-                break;
-            uint16_t range = tick * (1000 / WDT_FREQ) % 1000;
-            if (range < 500)
-                LED_On(LED_D3);
-            else
-                LED_Off(LED_D3);
-        }
+    if (dfu || !responded)
+        WaitForModule();
+#ifndef ESRILLE_NEW_KEYBOARD
+    WriteNvramCommon(NVRAM_COMMON_HOS_INFO, &info, sizeof info);
+    if (dfu && tuned) {
+        // Tune again for the updated module.
+        uint8_t setting = 0;
+        spi = SPI_SAFE;
+        tuned = false;
+        WriteNvramCommon(NVRAM_COMMON_HOS_SPI, &setting, 1);
     }
+#endif
 
     // Disable watchdog timer
     WDTCONbits.SWDTEN = 0;
@@ -421,30 +696,234 @@ void HosCheckDFU(bool dfu)
 
 #ifndef ESRILLE_NEW_KEYBOARD
 
-// Lower the clock frequency to extend battery life.
-// Note lowering frequency saves battery better than sleeping with WDT.
+#define STARTUP_TICK    (HOS_TIMER0_FREQ / WDT_FREQ)    // [Timer0 count]
+#define STARTUP_IDLE    (HOS_TIMER0_FREQ / 2u)          // while the module is overdue
+
+enum {
+    STARTUP_INFO,
+    STARTUP_SLEEP,
+    STARTUP_DONE
+};
+
+// In the USB mode, gets the module info and puts the module to sleep a step
+// at a time from the main loop so that the USB device can be attached without
+// waiting for the module. Returns true once done.
+bool HosStartupTasks(void)
+{
+    static uint8_t state = STARTUP_INFO;
+    static uint16_t tries;
+    static uint16_t last;
+    uint16_t now = ReadTimer0();
+
+    switch (state) {
+    case STARTUP_INFO:
+        if (tries && (uint16_t) (now - last) < ((tries < HOS_STARTUP_DELAY) ? STARTUP_TICK : STARTUP_IDLE))
+            return false;
+        last = now;
+        if (!HosGetStatus(HOS_TYPE_INFO)) {
+            if (tries < HOS_STARTUP_DELAY)
+                ++tries;
+            return false;
+        }
+        WriteNvramCommon(NVRAM_COMMON_HOS_INFO, &info, sizeof info);
+        state = STARTUP_SLEEP;
+        tries = 0;
+        // FALL THROUGH
+    case STARTUP_SLEEP:
+        if (tries && (uint16_t) (now - last) < STARTUP_TICK)
+            return false;
+        last = now;
+        if (!HosSleep(HOS_TYPE_DEFAULT) && ++tries < HOS_STARTUP_DELAY)
+            return false;
+        state = STARTUP_DONE;
+        break;
+    default:
+        break;
+    }
+    return state == STARTUP_DONE;
+}
+
+typedef struct Buffered {
+    uint16_t stamp;
+    uint8_t report[8];
+} Buffered;
+
+static Buffered buffered[HOS_BUFFER_SIZE];
+static uint8_t buffered_head;
+static uint8_t buffered_count;
+static uint16_t uptime;     // in ticks
+static uint16_t startup;    // uptime when first connected
+
+uint16_t HosGetStartupTime(void)
+{
+    if (65535u / (1000 / WDT_FREQ) < startup)
+        return 65535u;
+    return startup * (1000 / WDT_FREQ);
+}
+
+// Each report is a snapshot of the keys. The reports are kept in order from
+// the oldest one, and a report without a transition is not kept. Once the
+// buffer is full, the last slot collapses the newer reports into the latest
+// snapshot; the transitions in between are lost, but the keys end up in the
+// same state on the host.
+static void BufferReport(const uint8_t* report)
+{
+    uint8_t i;
+
+    if (buffered_count) {
+        i = (buffered_head + buffered_count - 1) & (HOS_BUFFER_SIZE - 1);
+        if (!memcmp(buffered[i].report, report, 8))
+            return;
+    }
+    if (buffered_count < HOS_BUFFER_SIZE)
+        i = (buffered_head + buffered_count++) & (HOS_BUFFER_SIZE - 1);
+    buffered[i].stamp = uptime;
+    memcpy(buffered[i].report, report, 8);
+}
+
+// True while the last report buffered has a key down, i.e. until its
+// release has been buffered, too.
+static bool BufferHoldsKeys(void)
+{
+    static const uint8_t released[8];
+
+    if (!buffered_count)
+        return false;
+    return memcmp(buffered[(buffered_head + buffered_count - 1) & (HOS_BUFFER_SIZE - 1)].report, released, 8);
+}
+
+static void FlushBuffer(void)
+{
+    for (uint8_t n = 0; buffered_count && n < HOS_BUFFER_BURST;) {
+        Buffered* b = &buffered[buffered_head];
+        if ((uint16_t) (uptime - b->stamp) < HOS_BUFFER_AGE) {
+            if (!HosReport(HOS_TYPE_DEFAULT, HOS_CMD_KEYBOARD_REPORT, 8, b->report))
+                return;     // Try again in the next tick.
+            ++n;
+        }
+        buffered_head = (buffered_head + 1) & (HOS_BUFFER_SIZE - 1);
+        --buffered_count;
+    }
+}
+
+#ifdef ENABLE_MOUSE
+
+static uint8_t mouse_report[4];
+static int16_t mouse_motion[3];     // x, y, and wheel not reported yet
+static bool mouse_pending;          // mouse_report has to be sent again
+
+static int8_t TakeMotion(int16_t* motion)
+{
+    int8_t delta;
+
+    if (*motion < -127)
+        delta = -127;
+    else if (127 < *motion)
+        delta = 127;
+    else
+        delta = *motion;
+    *motion -= delta;
+    return delta;
+}
+
+// Called once per tick, which is longer than a BLE connection interval of the
+// module. Motion is added up between the ticks, and no report is sent without
+// a button change or pending motion.
+static void ReportMouse(void)
+{
+    uint8_t buttons = getKeyboardMouseButtons();
+
+    mouse_motion[0] += getKeyboardMouseX();
+    mouse_motion[1] += getKeyboardMouseY();
+    mouse_motion[2] += getKeyboardMouseWheel();
+    if (buttons == mouse_report[0] && !mouse_pending &&
+        !mouse_motion[0] && !mouse_motion[1] && !mouse_motion[2])
+        return;
+    mouse_report[0] = buttons;
+    for (uint8_t i = 0; i < 3; ++i)
+        mouse_report[i + 1] = TakeMotion(&mouse_motion[i]);
+    mouse_pending = !HosReport(HOS_TYPE_DEFAULT, HOS_CMD_MOUSE_REPORT, sizeof mouse_report, mouse_report);
+    if (mouse_pending) {
+        // Try again in the next tick.
+        for (uint8_t i = 0; i < 3; ++i)
+            mouse_motion[i] += (int8_t) mouse_report[i + 1];
+    }
+}
+
+#endif
+
+// Lower the clock frequency to extend battery life, and sleep until a key is
+// pressed. Note lowering frequency saves battery better than sleeping with WDT
+// at 48MHz, and sleeping at 125kHz saves even more than running at 125kHz.
 static void WaitForResume(void)
 {
+    uint16_t idle = 0;
+    uint8_t pmd[4];
+    uint8_t gie = INTCONbits.GIE;
+
+    pmd[0] = PMDIS0;
+    pmd[1] = PMDIS1;
+    pmd[2] = PMDIS2;
+    pmd[3] = PMDIS3;
+
     APP_LEDUpdate(0);
+    SyncNvram();            // Save the profile selection while nothing is typed.
 
-    WDTCONbits.REGSLP = 1;
-    WDTCONbits.SWDTEN = 0;
+    INTCONbits.GIE = 0;     // Key interrupts only wake us up.
     APP_Suspend();
+    BUTTON_EnableWakeUp();
 
-    while (!BUTTON_IsPressed()) {
-        _delay(16000 / 32);  // Note _delay(1) = 32 [usec] while suspended at 125kHz.
+    // Keep watchdog timer running to check the columns without interrupts.
+    WDTCONbits.REGSLP = 1;
+    WDTCONbits.SWDTEN = 1;
+    while (!BUTTON_IsDown()) {
+        Sleep();
+        Nop();
+        BUTTON_ClearWakeUpFlags();
+        ++power.suspended;
+        if (idle < HOS_BUFFER_AGE)
+            ++idle;
     }
+    uptime += idle;     // Let the buffered reports age while suspended.
 
+    BUTTON_DisableWakeUp();
     APP_WakeFromSuspend();
-    // Enable watchdog timer again
-    WDTCONbits.REGSLP = 1;
-    WDTCONbits.SWDTEN = 1;
+
+    PMDIS0 = pmd[0];
+    PMDIS1 = pmd[1];
+    PMDIS2 = pmd[2];
+    PMDIS3 = pmd[3];
+    INTCONbits.GIE = gie;
+}
+
+static uint16_t awake;      // Timer0 count at the last wake-up
+
+// Sleep until the next tick keeping track of the time spent in each state.
+// The dimmed LEDs are lit from each wake-up for their on-pulses, which are
+// not counted in power.led.
+static void Doze(void)
+{
+    while (LED_Pulse((uint16_t) (ReadTimer0() - awake), HOS_LED_PULSE))
+        ;
+    power.active += (uint16_t) (ReadTimer0() - awake);
+    ++power.sleeping;
+    for (uint8_t i = 0; i < LED_COUNT; ++i) {
+        if (LED_Get(LED_D1 + i))
+            ++power.led[i];
+    }
+    Sleep();
+    Nop();
+    awake = ReadTimer0();
+    LED_Tick();
 }
 
 void HosMainLoop(void)
 {
     static int8_t starting = 1;
-    static uint8_t mouse_report[4];
+    bool ready = false;             // true once the module has responded
+    bool booting = false;           // the module did not respond at first
+    uint8_t polls = 0;              // key scans since the last status poll
+    uint8_t syncing = 0;            // ticks left before re-sending HOS_EVENT_KEY_x
 
     if (isUSBMode() && isBusPowered())
         return;
@@ -459,33 +938,46 @@ void HosMainLoop(void)
     WDTCONbits.REGSLP = 1;
     WDTCONbits.SWDTEN = 1;
 
-    for (uint16_t i = 0; i < HOS_STARTUP_DELAY; ++i) {
-        if (HosGetStatus(HOS_TYPE_INFO)) {
-            break;
-        }
-        Sleep();
-        Nop();
-    }
+    // Timer0 is used to measure transactions as in the USB mode.
+    OpenTimer0(TIMER_INT_OFF & T0_16BIT & T0_SOURCE_INT & T0_PS_1_256);
+    awake = ReadTimer0();
+
     LED_Off(LED_D1);
     LED_Off(LED_D2);
     LED_Off(LED_D3);
+    for (LED i = LED_D1; i <= LED_D3; ++i)
+        LED_SetLevel(i, policy->led);
 
     for (uint16_t tick = 0;; ++tick)
     {
         uint8_t* keyboard_report = APP_KeyboardScan();
 
+        ++uptime;
+
         if (HosGetProfile() != CurrentProfile()) {
-            if (HosGetIndication() == HOS_BLE_STATE_CONNECTED && keyboard_report) {
-                // Send break
-                HosReport(HOS_TYPE_DEFAULT, HOS_CMD_KEYBOARD_REPORT, 8, keyboard_report);
-                Sleep();
-                Nop();
+            if (HosGetIndication() == HOS_BLE_STATE_CONNECTED && !syncing) {
+                // Release everything on the previous host.
+                if (keyboard_report) {
+                    // Send break
+                    HosReport(HOS_TYPE_DEFAULT, HOS_CMD_KEYBOARD_REPORT, 8, keyboard_report);
+                    keyboard_report = NULL;
+                }
+#ifdef ENABLE_MOUSE
+                memset(mouse_motion, 0, sizeof mouse_motion);
+                mouse_pending = false;
+                if (mouse_report[0]) {
+                    memset(mouse_report, 0, sizeof mouse_report);
+                    HosReport(HOS_TYPE_DEFAULT, HOS_CMD_MOUSE_REPORT, sizeof mouse_report, mouse_report);
+                }
+#endif
+                Doze();
             }
         }
 
         if (isUSBMode()) {
             if (isBusPowered()) {
                 HosGetStatus(HOS_TYPE_INFO);  // Get info after reset.
+                SyncNvram();
                 Reset();
                 Nop();
                 Nop();
@@ -493,27 +985,66 @@ void HosMainLoop(void)
             }
         }
 
+        if (!ready) {
+            // Start scanning right away and keep the keys typed until the
+            // module responds, which takes a while after power-up.
+            if (HosGetStatus(HOS_TYPE_INFO)) {
+                ready = true;
+            } else if (HOS_STARTUP_DELAY <= uptime) {
+                WaitForModule();
+                ready = true;
+            } else {
+                booting = true;
+                if (keyboard_report)
+                    BufferReport(keyboard_report);
+                Doze();
+                continue;
+            }
+            WriteNvramCommon(NVRAM_COMMON_HOS_INFO, &info, sizeof info);
+            // Tune only a module that has just booted, before it has a link,
+            // rather than one left running over a reset of the MCU alone.
+            if (!tuned && booting)
+                HosTuneSPI();
+        }
+
+        if (spi_fallback) {
+            // Save the fallback without SPI_TUNED so that the next cold
+            // boot tunes again instead of keeping the slow setting for good.
+            uint8_t setting = SPI_SAFE;
+            spi_fallback = false;
+            tuned = false;
+            WriteNvramCommon(NVRAM_COMMON_HOS_SPI, &setting, 1);
+        }
+
         if (HosGetProfile() != CurrentProfile()) {
-            for (uint8_t i = 0; !HosGetStatus(HOS_TYPE_DEFAULT) && i < HOS_SYNC_DELAY; ++i) {
-                Sleep();
-                Nop();
+            // Do not wait for the module here; keep scanning while it switches
+            // the link, and re-send the event only if it has not been taken.
+            if (syncing) {
+                --syncing;
+                HosGetStatus(HOS_TYPE_DEFAULT);
             }
-            if (HosGetProfile() != CurrentProfile()) {
+            if (!syncing && HosGetProfile() != CurrentProfile()) {
                 HosSetEvent(HOS_TYPE_DEFAULT, HOS_EVENT_KEY_0 + CurrentProfile());
                 APP_LEDUpdate(1u << (CurrentProfile() -1));
+                syncing = HOS_SYNC_DELAY;
             }
+            if (keyboard_report)
+                BufferReport(keyboard_report);
             tick = 0;   // Reset
         }
         else
         {
+            syncing = 0;
             switch (HosGetIndication()) {
             case HOS_BLE_STATE_IDLE:
+                if (keyboard_report)
+                    BufferReport(keyboard_report);
                 if (keyboard_report || starting) {
                     starting = 1;
                     tick = 0;   // Reset
                     HosGetStatus(HOS_TYPE_DEFAULT);
                 }
-                HosUpdateLED(CurrentProfile(), tick);
+                HosUpdateLED(CurrentProfile());
                 break;
 
             case HOS_BLE_STATE_ADVERTISING:
@@ -521,14 +1052,16 @@ void HosMainLoop(void)
             case HOS_BLE_STATE_ADVERTISING_SLOW:
             case HOS_BLE_STATE_ADVERTISING_DIRECTED:
                 starting = 0;
+                if (keyboard_report)
+                    BufferReport(keyboard_report);
                 HosGetStatus(HOS_TYPE_DEFAULT);
                 // A new bonding process can be interrupted if there are pre-bonded peers that are active.
                 // In such a case, the BLE module timers are also reset, and we must manually stop
                 // advertising if a new bonding cannot be made within a reasonable time.
-                if (HOS_ADV_TIMEOUT < tick) {
+                if (policy->advTimeout < tick) {
                     HosSleep(HOS_TYPE_DEFAULT);
                 }
-                HosUpdateLED(CurrentProfile(), tick);
+                HosUpdateLED(CurrentProfile());
                 break;
 
             case HOS_BLE_STATE_BONDING:
@@ -538,29 +1071,27 @@ void HosMainLoop(void)
                 } else {
                     HosGetStatus(HOS_TYPE_DEFAULT);
                 }
-                HosUpdateLED(CurrentProfile(), tick);
+                HosUpdateLED(CurrentProfile());
                 break;
 
             case HOS_BLE_STATE_CONNECTED:
-                if (keyboard_report) {
+                if (!startup)
+                    startup = uptime;
+                if (buffered_count) {
+                    // Replay what has been typed while disconnected in order.
+                    if (keyboard_report)
+                        BufferReport(keyboard_report);
+                    FlushBuffer();
+                } else if (keyboard_report) {
                     HosReport(HOS_TYPE_DEFAULT, HOS_CMD_KEYBOARD_REPORT, 8, keyboard_report);
-                } else {
+                } else if (policy->poll <= ++polls) {
+                    polls = 0;
                     HosGetStatus(HOS_TYPE_DEFAULT);
                 }
 #ifdef ENABLE_MOUSE
-                // Do not report unchanged state.
+                processMouseWheel((1000u / WDT_FREQ) * policy->scan);
                 processMouseData();
-                if (mouse_report[0] != getKeyboardMouseButtons() ||
-                    mouse_report[1] != 0 || mouse_report[1] != getKeyboardMouseX() ||
-                    mouse_report[2] != 0 || mouse_report[2] != getKeyboardMouseY() ||
-                    mouse_report[3] != 0 || mouse_report[3] != getKeyboardMouseWheel())
-                {
-                    mouse_report[0] = getKeyboardMouseButtons();
-                    mouse_report[1] = getKeyboardMouseX();
-                    mouse_report[2] = getKeyboardMouseY();
-                    mouse_report[3] = getKeyboardMouseWheel();
-                    HosReport(HOS_TYPE_DEFAULT, HOS_CMD_MOUSE_REPORT, sizeof mouse_report, mouse_report);
-                }
+                ReportMouse();
 #endif
                 APP_LEDUpdate(controlLED(HosGetLED()));
                 HosUpdateBatteryLevel(tick);
@@ -569,6 +1100,7 @@ void HosMainLoop(void)
             default:
                 APP_LEDUpdate(LED_NUM_LOCK | LED_CAPS_LOCK | LED_SCROLL_LOCK);
                 HosGetStatus(HOS_TYPE_INFO);  // Get info after reset.
+                SyncNvram();
                 Reset();
                 Nop();
                 Nop();
@@ -576,12 +1108,22 @@ void HosMainLoop(void)
                 break;
             }
 
-            if (HosGetSuspended() || HosGetIndication() == HOS_BLE_STATE_IDLE)
+            // The key that wakes us up is scanned at the tick rate and
+            // buffered once debounced; keep scanning until its release is
+            // buffered as well so that it is typed once.
+            if ((HosGetSuspended() || HosGetIndication() == HOS_BLE_STATE_IDLE) && !BufferHoldsKeys()) {
                 WaitForResume();
+                awake = ReadTimer0();
+            }
         }
 
-        Sleep();
-        Nop();
+        Doze();
+        // Scan less often as the battery runs low.
+        for (uint8_t i = 1; i < policy->scan; ++i) {
+            Doze();
+            ++tick;
+            ++uptime;
+        }
     }
 }
 
@@ -22,6 +22,13 @@
  *
  * See "Bluetooth Qualification and Declaration Processes" for more details:
  *   https://www.bluetooth.org/en-us/test-qualification/qualification-overview
+ *
+ * NOTE: This file has been modified since the qualification: the report
+ * buffering while disconnected, the profile switch without waiting, the SPI
+ * tuning, the transport and power statistics, the key wake-up on suspend,
+ * the LED sequencer, the power governor, the mouse coalescing, and the USB
+ * mode start-up. A firmware built from it is not covered by the existing
+ * qualification and has to be requalified before it is released as such.
  */
 
 #ifndef HOS_MASTER_H
@@ -36,14 +43,60 @@
 #define HOS_SYNC_DELAY      (WDT_FREQ / 2u)     // Usually it takes about 240 msec to 300 msec to restart.
 #define HOS_ADV_TIMEOUT     (WDT_FREQ * 210u)   // > APP_ADV_FAST_TIMEOUT + APP_ADV_SLOW_TIMEOUT
 
+// Keyboard reports typed while the link is down are buffered and replayed
+// once the connection is back. 16 reports, 160 bytes of RAM, keep a second of
+// typing at 8 keys per second; see tools/hossim -d.
+#ifndef HOS_BUFFER_SIZE
+#define HOS_BUFFER_SIZE     16u                 // must be a power of 2
+#endif
+#define HOS_BUFFER_BURST    4u                  // max reports replayed per tick
+#ifndef HOS_BUFFER_AGE
+#define HOS_BUFFER_AGE      (WDT_FREQ * 10u)    // reports older than this are discarded
+#endif
+
+#ifndef HOS_LED_LEVEL
+#define HOS_LED_LEVEL       (LED_LEVEL_MAX / 2u)    // LED brightness on battery
+#endif
+// The LEDs below LED_LEVEL_MAX are lit for a share of this period at each
+// wake-up; the 0.5 ms of HOS_LED_LEVEL mostly overlaps the key scan.
+#define HOS_LED_PULSE       (HOS_TIMER0_FREQ / 1000u)   // [Timer0 count] 1 ms
+// Half the on-pulse of HOS_LED_LEVEL, which ends within the key scan.
+#define HOS_LED_LEVEL_LOW   ((HOS_LED_LEVEL + 1u) / 2u) // LED brightness on low battery
+
+// Battery-aware power policy in the BLE mode. Each step applies at and below
+// its battery level; the first step must cover 100%.
+typedef struct HosPolicy {
+    uint8_t  level;         // battery level [%]
+    uint8_t  scan;          // WDT ticks per key scan
+    uint8_t  poll;          // key scans per status poll while connected and idle
+    uint8_t  led;           // LED brightness, 0 to LED_LEVEL_MAX; see HOS_LED_PULSE
+    uint16_t advTimeout;    // advertising ticks before putting the module to sleep
+} HosPolicy;
+
+#ifndef HOS_GOVERNOR_CURVE
+#define HOS_GOVERNOR_CURVE                                      \
+    { 100, 1, 1, HOS_LED_LEVEL,     HOS_ADV_TIMEOUT },          \
+    {  20, 1, 2, HOS_LED_LEVEL_LOW, HOS_ADV_TIMEOUT },          \
+    {   8, 2, 4, HOS_LED_LEVEL_LOW, (WDT_FREQ * 120u) },        \
+    {   2, 3, 8, HOS_LED_LEVEL_LOW, (WDT_FREQ * 60u) }
+#endif
+#define HOS_GOVERNOR_HYSTERESIS 3u  // [%] to step back up
+
 void HosInitialize(void);
 
+#ifdef HOS_SPI_HOOK
+// The HOS bus is provided outside of this module, e.g., by tools/hossim.
+void HosSpiSelect(uint8_t cs);
+#endif
+uint8_t HosXfer(uint8_t byte);
+
 int8_t HosReport(uint8_t type, uint8_t cmd, uint8_t len, const uint8_t* data);
 int8_t HosGetStatus(uint8_t type);
 int8_t HosSetEvent(uint8_t type, uint8_t key);
 int8_t HosSetBatteryLevel(uint8_t type, uint8_t level);
 int8_t HosSleep(uint8_t type);
 int8_t HosReset(uint8_t gpregret);
+void HosTuneSPI(void);
 
 uint8_t HosGetLED(void);
 uint8_t HosGetProfile(void);
@@ -53,7 +106,35 @@ uint8_t HosGetIndication(void);
 uint8_t HosGetSuspended(void);
 uint8_t HosGetLESC(void);
 
-void HosUpdateLED(LED led, uint16_t tick);
+void HosUpdateLED(LED led);
+
+const HosPolicy* HosGovern(uint8_t level);
+const HosPolicy* HosGetPolicy(void);
+
+// Transport statistics; counters saturate at 0xffff.
+typedef struct HosStats {
+    uint16_t xfers[HOS_CMD_KEYBOARD_REPORT - HOS_CMD_GET_STATUS + 1];  // by command
+    uint16_t retries;   // HOS_DEF_CHARACTER replies
+    uint16_t bad;       // broken profile bytes
+    uint16_t failures;  // HosReport() calls that did not succeed
+    uint16_t worst;     // the longest HosReport() in usec
+} HosStats;
+
+// Power state residency in the BLE mode
+typedef struct HosPower {
+    uint32_t active;            // awake between ticks [Timer0 count]
+    uint32_t spi;               // in HosReport() [Timer0 count]
+    uint32_t sleeping;          // in Sleep() between ticks [tick]
+    uint32_t suspended;         // in WaitForResume() [tick]
+    uint32_t led[LED_COUNT];    // LED_D1 to LED_D3 turned on [tick]
+} HosPower;
+
+#define HOS_TIMER0_FREQ     (_XTAL_FREQ / 4u / 256u)    // Timer0 count per second
+
+const HosStats* HosGetStats(void);
+const HosPower* HosGetPower(void);
+void HosClearStats(void);
+void HosPrintStats(void);
 
 // Information
 uint16_t HosGetVersion(void);
@@ -64,7 +145,11 @@ uint16_t HosGetTouch(void);
 uint8_t HosGetKeyboardMouseX(void);
 uint8_t HosGetKeyboardMouseY(void);
 
+// Time from power-up until the first connection in msec
+uint16_t HosGetStartupTime(void);
+
 void HosCheckDFU(bool dfu);
+bool HosStartupTasks(void);
 void HosMainLoop(void);
 
 #endif // HOS_MASTER_H
@@ -517,9 +517,11 @@
 #define EEPROM_IME      6
 #define EEPROM_MOUSE    7
 #define EEPROM_PREFIX   8
+#define EEPROM_SETTINGS 9   // bytes of the settings in a profile
 
 void initKeyboard(void);
 void loadKeyboardSettings(void);
+uint8_t checkSettings(const uint8_t* settings);
 void loadBaseSettings(void);
 void loadKanaSettings(void);
 
@@ -658,6 +660,15 @@ uint8_t getKeyBase(uint8_t code);
 
 #define MAX_MACRO_SIZE  254
 
+typedef struct {
+    uint16_t ghosts;    // scans discarded for ghosting
+    uint16_t bounces;   // key samples that did not last through the delay
+    uint8_t macroMax;   // the deepest macro queue
+} KeyboardStats;
+
+const KeyboardStats* getKeyboardStats(void);
+uint8_t getMacroDepth(void);
+
 uint8_t beginMacro(uint8_t max);
 uint8_t peekMacro(void);
 uint8_t getMacro(void);
@@ -665,7 +676,7 @@ void emitKey(uint8_t key);
 void emitString(const uint8_t s[]);
 void emitStringN(const uint8_t s[], uint8_t len);
 #if APP_MACHINE_VALUE != 0x4550
-void emitNumber(uint16_t n);
+void emitNumber(uint32_t n);
 #endif
 
 extern uint8_t os;
@@ -20,6 +20,7 @@
 #include <stdint.h>
 #include <string.h>
 #include <system.h>
+#include <app_device_keyboard.h>
 
 #define DUAL_FN_TIMEOUT     16
 
@@ -163,6 +164,8 @@ static uint8_t ordered_keys[MAX_MACRO_SIZE];
 static uint8_t ordered_pos = 0;
 static uint8_t ordered_max;
 
+static KeyboardStats stats;
+
 static uint8_t currentDelay;
 static Keys keys[DELAY_MAX + 2];
 static int8_t currentKey = 0;
@@ -213,6 +216,21 @@ void loadKeyboardSettings(void)
     loadKanaSettings();
 }
 
+// Return 1 if every EEPROM_* field of settings is in range.
+uint8_t checkSettings(const uint8_t* settings)
+{
+    static const uint8_t max[EEPROM_SETTINGS] = {
+        BASE_MAX, KANA_MAX, OS_MAX, DELAY_MAX, MOD_MAX, LED_MAX, IME_MAX,
+        PAD_SENSE_MAX, PREFIXSHIFT_MAX
+    };
+
+    for (uint8_t i = 0; i < EEPROM_SETTINGS; ++i) {
+        if (max[i] < settings[i])
+            return 0;
+    }
+    return 1;
+}
+
 void emitOSName(void)
 {
     emitStringN(osKeys[os], MAX_OS_KEY_NAME);
@@ -335,11 +353,26 @@ static int8_t detectGhost(void)
             ++cx;
     }
     detected = (2 <= rx && 2 <= cx);
+    if (detected)
+        ++stats.ghosts;
     memset(rowCount, 0, sizeof rowCount);
     memset(columnCount, 0, sizeof columnCount);
     return detected;
 }
 
+const KeyboardStats* getKeyboardStats(void)
+{
+    return &stats;
+}
+
+// Return the number of keys queued while emitting, or left to be sent.
+uint8_t getMacroDepth(void)
+{
+    if (ordered_max)
+        return ordered_max - ordered_pos;
+    return ordered_pos;
+}
+
 uint8_t beginMacro(uint8_t max)
 {
     ordered_pos = 1;
@@ -371,6 +404,8 @@ void emitKey(uint8_t c)
         ordered_keys[ordered_pos++] = c;
     if (ordered_pos < sizeof ordered_keys)
         ordered_keys[ordered_pos] = 0;
+    if (stats.macroMax < ordered_pos)
+        stats.macroMax = ordered_pos;
 }
 
 void emitString(const uint8_t s[])
@@ -399,11 +434,11 @@ static uint8_t getNumKeycode(unsigned int n)
 }
 
 #if APP_MACHINE_VALUE != 0x4550
-void emitNumber(uint16_t n)
+void emitNumber(uint32_t n)
 {
     int8_t zero = 0;
 
-    for (uint16_t i = 10000;;) {
+    for (uint32_t i = 1000000000;;) {
         uint8_t d = n / i;
         if (d || zero) {
             zero = 1;
@@ -472,6 +507,75 @@ static const uint8_t about_lesc[] = {
     KEY_L, KEY_E, KEY_S, KEY_C, KEY_SPACEBAR, 0
 };
 
+static const uint8_t about_boot[] = {
+    KEY_B, KEY_O, KEY_O, KEY_T, KEY_SPACEBAR, 0
+};
+
+static const uint8_t about_hos[] = {
+    KEY_H, KEY_O, KEY_S, KEY_SPACEBAR, 0
+};
+
+static const uint8_t about_pwr[] = {
+    KEY_P, KEY_W, KEY_R, KEY_SPACEBAR, 0
+};
+
+static const uint8_t about_led[] = {
+    KEY_SPACEBAR, KEY_L, KEY_E, KEY_D, KEY_SPACEBAR, 0
+};
+
+#endif
+
+#if APP_MACHINE_VALUE != 0x4550
+static const uint8_t about_que[] = {
+    KEY_Q, KEY_U, KEY_E, KEY_SPACEBAR, 0
+};
+
+#ifdef USB_SOF_SYNC
+static const uint8_t about_sof[] = {
+    KEY_S, KEY_O, KEY_F, KEY_SPACEBAR, 0
+};
+
+static void emitMicroseconds(uint32_t counts)
+{
+    emitNumber(counts * 1000000 / APP_TIMER0_FREQ);
+}
+
+// Longest scan, and then the shortest, average and longest time from
+// loading a report to its IN token in usec
+static void emitTiming(void)
+{
+    const APP_KEYBOARD_TIMING* timing = APP_KeyboardGetTiming();
+
+    emitString(about_sof);
+    emitMicroseconds(timing->scan);
+    emitKey(KEY_SPACEBAR);
+    if (timing->count) {
+        emitMicroseconds(timing->min);
+        emitKey(KEY_SLASH);
+        emitMicroseconds(timing->sum / timing->count);
+        emitKey(KEY_SLASH);
+        emitMicroseconds(timing->max);
+    }
+    emitKey(KEY_U);
+    emitKey(KEY_S);
+    emitKey(KEY_ENTER);
+}
+#endif
+
+// Reports merged and scans put off by the USB report queue
+static void emitUSBStats(void)
+{
+    const APP_KEYBOARD_STATS* stats = APP_KeyboardGetStats();
+
+    emitString(about_que);
+    emitNumber(stats->merges);
+    emitKey(KEY_SLASH);
+    emitNumber(stats->stalls);
+    emitKey(KEY_ENTER);
+#ifdef USB_SOF_SYNC
+    emitTiming();
+#endif
+}
 #endif
 
 static void about(void)
@@ -514,9 +618,62 @@ static void about(void)
         emitString(about_lesc);
         emitKey(getNumKeycode(HosGetLESC()));
         emitKey(KEY_ENTER);
+
+        emitString(about_boot);
+        emitNumber(HosGetStartupTime());
+        emitKey(KEY_M);
+        emitKey(KEY_S);
+        emitKey(KEY_ENTER);
+
+        // Transactions by command, retries, bad frames, failures, and the worst time
+        const HosStats* stats = HosGetStats();
+        emitString(about_hos);
+        for (uint8_t i = 0; i < sizeof stats->xfers / sizeof stats->xfers[0]; ++i) {
+            if (i)
+                emitKey(KEY_SLASH);
+            emitNumber(stats->xfers[i]);
+        }
+        emitKey(KEY_SPACEBAR);
+        emitNumber(stats->retries);
+        emitKey(KEY_SLASH);
+        emitNumber(stats->bad);
+        emitKey(KEY_SLASH);
+        emitNumber(stats->failures);
+        emitKey(KEY_SPACEBAR);
+        emitNumber(stats->worst);
+        emitKey(KEY_U);
+        emitKey(KEY_S);
+        emitKey(KEY_ENTER);
+
+        // Active, SPI, sleeping and suspended time, and then LED on time in seconds
+        const HosPower* power = HosGetPower();
+        emitString(about_pwr);
+        emitNumber(power->active / HOS_TIMER0_FREQ);
+        emitKey(KEY_SLASH);
+        emitNumber(power->spi / HOS_TIMER0_FREQ);
+        emitKey(KEY_SLASH);
+        emitNumber(power->sleeping / WDT_FREQ);
+        emitKey(KEY_SLASH);
+        emitNumber(power->suspended / WDT_FREQ);
+        emitKey(KEY_S);
+        emitString(about_led);
+        for (uint8_t i = 0; i < LED_COUNT; ++i) {
+            if (i)
+                emitKey(KEY_SLASH);
+            emitNumber(power->led[i] / WDT_FREQ);
+        }
+        emitKey(KEY_S);
+        emitKey(KEY_ENTER);
+        HosPrintStats();
+    }
+    else {
+        emitUSBStats();
     }
 #else
     emitString(about_copyright);
+#if APP_MACHINE_VALUE != 0x4550
+    emitUSBStats();
+#endif
 #endif
 
     // F2 OS
@@ -974,6 +1131,8 @@ int8_t makeReport(uint8_t* report)
             uint8_t key = keys[at].keys[i];
             if (memchr(keys[prev].keys + 2, key, 6))
                 current[count++] = key;
+            else if (key != VOID_KEY && !memchr(processed + 2, key, 6))
+                ++stats.bounces;
         }
         while (count < 8)
             current[count++] = VOID_KEY;
@@ -1057,14 +1216,6 @@ uint8_t controlLED(uint8_t report)
     if (isMouseTouched())
         report |= LED_SCROLL_LOCK;
 #endif
-    if (BOARD_REV_VALUE < 3) {
-        static int8_t tick;
-
-        if (4 <= ++tick)
-            tick = 0;
-        else
-            report &= ~LED_NUM_LOCK;
-    }
     return report;
 }
 
@@ -0,0 +1,134 @@
+/*
+ * Copyright 2026 Esrille Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/*
+ * The LED sequencer shared by the boards: LED_On()/LED_Off() states,
+ * brightness levels and blink patterns. Each board's leds.c provides
+ * LED_Initialize() and LED_Drive() for its own pins.
+ *
+ * An LED dimmed below LED_LEVEL_MAX is lit by LED_Tick() and darkened by
+ * LED_Pulse() once its share of the period has elapsed, so that it is
+ * dimmed within every tick rather than by skipping whole ticks, which
+ * flickers at the tick rates of the main loops.
+ */
+
+#include <stddef.h>
+#include <system.h>
+
+static uint8_t ledState;                // set by LED_On() and LED_Off()
+static uint8_t ledBlink;                // blink phase of the patterns
+static uint8_t ledLit;                  // lit since the last LED_Tick()
+static uint8_t ledLevel[LED_COUNT] = { LED_LEVEL_MAX, LED_LEVEL_MAX, LED_LEVEL_MAX };
+static uint8_t ledCount[LED_COUNT];     // ticks left in the blink phase
+static const LED_PATTERN* ledPattern[LED_COUNT];
+
+static void LED_Apply(uint8_t i)
+{
+    uint8_t bit = 1u << i;
+    uint8_t on = ledPattern[i] ? ledBlink : ledState;
+
+    if ((on & bit) && ledLevel[i]) {
+        ledLit |= bit;
+        LED_Drive(LED_D1 + i, true);
+    } else {
+        ledLit &= ~bit;
+        LED_Drive(LED_D1 + i, false);
+    }
+}
+
+void LED_On(LED led)
+{
+    uint8_t i = led - LED_D1;
+
+    if (LED_COUNT <= i)
+        return;
+    ledPattern[i] = NULL;
+    ledState |= 1u << i;
+    LED_Apply(i);
+}
+
+void LED_Off(LED led)
+{
+    uint8_t i = led - LED_D1;
+
+    if (LED_COUNT <= i)
+        return;
+    ledPattern[i] = NULL;
+    ledState &= ~(1u << i);
+    LED_Apply(i);
+}
+
+void LED_SetLevel(LED led, uint8_t level)
+{
+    uint8_t i = led - LED_D1;
+
+    if (LED_COUNT <= i)
+        return;
+    ledLevel[i] = (LED_LEVEL_MAX < level) ? LED_LEVEL_MAX : level;
+    LED_Apply(i);
+}
+
+void LED_SetPattern(LED led, const LED_PATTERN* pattern)
+{
+    uint8_t i = led - LED_D1;
+
+    if (LED_COUNT <= i || ledPattern[i] == pattern)
+        return;
+    ledPattern[i] = pattern;
+    if (pattern) {
+        // Start with the on phase.
+        ledCount[i] = pattern->on;
+        if (pattern->on)
+            ledBlink |= 1u << i;
+        else
+            ledBlink &= ~(1u << i);
+    }
+    LED_Apply(i);
+}
+
+void LED_Tick(void)
+{
+    for (uint8_t i = 0; i < LED_COUNT; ++i) {
+        const LED_PATTERN* pattern = ledPattern[i];
+
+        if (pattern && pattern->on && pattern->off && --ledCount[i] == 0) {
+            ledBlink ^= 1u << i;
+            ledCount[i] = (ledBlink & (1u << i)) ? pattern->on : pattern->off;
+        }
+        LED_Apply(i);
+    }
+}
+
+bool LED_Pulse(uint16_t elapsed, uint16_t period)
+{
+    uint16_t step = period / LED_LEVEL_MAX;
+    bool lit = false;
+
+    for (uint8_t i = 0; i < LED_COUNT; ++i) {
+        uint8_t bit = 1u << i;
+
+        if (!(ledLit & bit) || LED_LEVEL_MAX <= ledLevel[i])
+            continue;
+        if (elapsed < (uint16_t) (step * ledLevel[i])) {
+            lit = true;
+        } else {
+            ledLit &= ~bit;
+            LED_Drive(LED_D1 + i, false);
+        }
+    }
+    return lit;
+}
@@ -15,6 +15,7 @@
  */
 
 #include "Mouse.h"
+#include "MouseCurve.h"
 #include "Keyboard.h"
 
 #include <system.h>
@@ -62,17 +63,32 @@ typedef struct {
 #define CODE_COMMA      (6*12+9)
 
 #define PLAY_XY         36      // x or y value smaller than PLAY_XY should be ignored.
-#define THRESH_XY       48      // x or y value threshold
+#define SCROLL_BUTTON   0x40
 #define AIM_BUTTON      0x80
 #define TOUCH_DELAY     12      // a very short touch should be ignored.
 #define TOUCH_THRESH    1000
 #define TOUCH_MAX       4095
-
-const static uint8_t normalTable[PAD_SENSE_MAX + 1] = {
-    3, 4, 5, 6
+#define SAMPLE_MAX      16      // must be a power of 2
+#define MOUSE_SHIFT     (MOUSE_CURVE_SHIFT + PAD_SAMPLE_SHIFT)
+
+// The wheel is accumulated in 1/(1 << WHEEL_SHIFT) notches. Holding a
+// wheel key scrolls at WHEEL_SPEED_MIN notches/sec at first, speeding up
+// to WHEEL_SPEED_MAX notches/sec in WHEEL_ACCEL_MSEC. Dragging on the pad
+// with the scroll key held scrolls a notch per (1 << WHEEL_DRAG_SHIFT)
+// counts.
+#define WHEEL_SHIFT         6
+#define WHEEL_SPEED_MIN     10
+#define WHEEL_SPEED_MAX     60
+#define WHEEL_ACCEL_MSEC    1000
+#define WHEEL_DRAG_SHIFT    3
+
+// Acceleration curves scaled by 3/3, 4/3, 5/3 and 6/3, and by 2/3 and 3/3
+// in aim mode; see tools/mousebench for how they are made.
+const static uint8_t* const normalTable[PAD_SENSE_MAX + 1] = {
+    mouseCurve3, mouseCurve4, mouseCurve5, mouseCurve6
 };
-const static uint8_t aimTable[PAD_SENSE_MAX + 1] = {
-    2, 2, 3, 3
+const static uint8_t* const aimTable[PAD_SENSE_MAX + 1] = {
+    mouseCurve2, mouseCurve2, mouseCurve3, mouseCurve3
 };
 
 static const uint8_t about[] = {
@@ -80,19 +96,33 @@ static const uint8_t about[] = {
 };
 
 static uint8_t resolution;
-static uint8_t tick;
 
 static uint8_t buttons;
 static int8_t  x;
 static int8_t  y;
 static int8_t  wheel;
+static int8_t  wheelKey;        // -1, 0, or 1 while a wheel key is held
+static uint16_t wheelHeld;      // how long the wheel key has been held [msec]
+static int16_t wheelMotion;     // [1/(1 << WHEEL_SHIFT) notch]
+static uint8_t wheelShift = WHEEL_SHIFT;    // to the reported wheel unit
 
-static SerialData rawData;
+static SerialData rawData;     // frame being received by the UART interrupt
 static TouchSensor touchSensor;
 
+// Frames received by the UART interrupt and not yet processed. Only the
+// interrupt advances sampleHead and only the main loop advances sampleTail.
+static SerialData samples[SAMPLE_MAX];
+static volatile uint8_t sampleHead;
+static volatile uint8_t sampleTail;
+static uint8_t sampleDrops;
+
 static Pos center;
 static Pos prev;
 
+// Motion carried over to the next sample [1/(1 << MOUSE_SHIFT) count]
+static int16_t remainderX;
+static int16_t remainderY;
+
 void initMouse(void)
 {
     touchSensor.current = touchSensor.thresh = touchSensor.high = 0;
@@ -120,6 +150,8 @@ void emitMouse(void)
     emitNumber(touchSensor.thresh);
     emitKey(KEY_SLASH);
     emitNumber(touchSensor.spurious);
+    emitKey(KEY_SLASH);
+    emitNumber(sampleDrops);
     emitKey(KEY_SPACEBAR);
     emitNumber(prev.x);
     emitKey(KEY_COMMA);
@@ -188,6 +220,9 @@ void processMouseKeys(uint8_t* current, const uint8_t* processed)
         case CODE_SEMICOLON:
             b |= AIM_BUTTON;
             break;
+        case CODE_H:
+            b |= SCROLL_BUTTON;
+            break;
         default:
             break;
         }
@@ -195,7 +230,12 @@ void processMouseKeys(uint8_t* current, const uint8_t* processed)
 
     // Update buttons and wheel atomically
     buttons = b;
-    wheel = w;
+    if (wheelKey != w) {
+        // A tap scrolls a notch.
+        wheelKey = w;
+        wheelHeld = 0;
+        wheelMotion = (int16_t) w << WHEEL_SHIFT;
+    }
 }
 
 static uint8_t distance(uint8_t raw, uint8_t center)
@@ -203,36 +243,38 @@ static uint8_t distance(uint8_t raw, uint8_t center)
     return (raw < center) ? (center - raw) : (raw - center);
 }
 
-static int8_t trimXY(uint8_t raw, uint8_t center)
+// Accumulate the motion for the offset from the centre in fractions of a
+// count, and return the whole counts moved so far.
+static int8_t trimXY(uint8_t raw, uint8_t center, int16_t* remainder)
 {
-    int8_t sign;
-    uint16_t value;
-    uint8_t r;
+    const uint8_t* curve;
+    uint8_t value;
+    int16_t motion;
+    int8_t out;
 
-    if (center <= raw) {
-        sign = 1;
-        value = raw - center;
-    } else {
-        sign = -1;
-        value = center - raw;
-    }
-    if (value < THRESH_XY / 2)
-        return 0;
     if (buttons & AIM_BUTTON)
-        r = aimTable[resolution];
+        curve = aimTable[resolution];
     else
-        r = normalTable[resolution];
-    value *= r;
-    value /= 3;
-    if (value < THRESH_XY) {
-        value = value * value / THRESH_XY * value / THRESH_XY * 10 / THRESH_XY;
-        value = (tick <= value) ? 1 : 0;
-    } else {
-        value = (value * value / (THRESH_XY * THRESH_XY)) * value / THRESH_XY;
-        if (128 <= value)
-            return (0 < sign) ? 127 : -127;
+        curve = normalTable[resolution];
+    value = curve[(center <= raw) ? (uint8_t) (raw - center) : (uint8_t) (center - raw)];
+    if (!value) {
+        *remainder = 0;
+        return 0;
     }
-    return sign * value;
+    if (value & MOUSE_CURVE_FRACTION)
+        motion = value & ~MOUSE_CURVE_FRACTION;
+    else
+        motion = (int16_t) value << MOUSE_CURVE_SHIFT;
+    if (center <= raw)
+        *remainder += motion;
+    else
+        *remainder -= motion;
+    if (*remainder < 0)
+        out = -(int8_t) ((-*remainder) >> MOUSE_SHIFT);
+    else
+        out = *remainder >> MOUSE_SHIFT;
+    *remainder -= (int16_t) out << MOUSE_SHIFT;
+    return out;
 }
 
 // Return 0.75 * prev + (1 - 0.75) * raw
@@ -243,9 +285,9 @@ static uint16_t lowPassFilter(uint16_t prev, uint16_t raw)
     return prev + raw;
 }
 
-static void processSerialData(void)
+static void processSerialData(const SerialData* data)
 {
-    uint16_t touch = rawData.touch;
+    uint16_t touch = data->touch;
 
     if (touch < TOUCH_THRESH) { // too weak
         touch = TOUCH_MAX;
@@ -263,10 +305,10 @@ static void processSerialData(void)
         if (0 < touchSensor.delay && touchSensor.delay < TOUCH_DELAY) {
             ++touchSensor.spurious;
         }
-        if ((distance(rawData.x, 128u) < PLAY_XY && distance(rawData.y, 128u) < PLAY_XY) || (center.x == 0 && center.y == 0)) {
-            if (rawData.x == prev.x && rawData.y == prev.y) {
-                center.x = rawData.x;
-                center.y = rawData.y;
+        if ((distance(data->x, 128u) < PLAY_XY && distance(data->y, 128u) < PLAY_XY) || (center.x == 0 && center.y == 0)) {
+            if (data->x == prev.x && data->y == prev.y) {
+                center.x = data->x;
+                center.y = data->y;
                 if (touchSensor.delay == TOUCH_DELAY) { // previously touched?
                     touchSensor.high = (touchSensor.high * 8) / 9;
                 }
@@ -274,12 +316,24 @@ static void processSerialData(void)
         }
         touchSensor.delay = 0;
     }
-    x = trimXY(rawData.x, center.x);
-    y = trimXY(rawData.y, center.y);
-    prev.x = rawData.x;
-    prev.y = rawData.y;
-    if (10 < ++tick)
-        tick = 0;
+    x = trimXY(data->x, center.x, &remainderX);
+    y = trimXY(data->y, center.y, &remainderY);
+    if (buttons & SCROLL_BUTTON) {
+        // Moving the finger up scrolls up.
+        wheelMotion -= (int16_t) y << (WHEEL_SHIFT - WHEEL_DRAG_SHIFT);
+        x = y = 0;
+    }
+    prev.x = data->x;
+    prev.y = data->y;
+}
+
+static int8_t clampXY(int16_t value)
+{
+    if (value < -127)
+        return -127;
+    if (127 < value)
+        return 127;
+    return value;
 }
 
 // Protocol:
@@ -287,6 +341,9 @@ static void processSerialData(void)
 // 0  t6 t5 t4 t3 t2 t1 t0
 // 0  x6 x5 x4 x3 x2 x1 x0
 // 0  y6 y5 y4 y3 y2 y1 y0
+//
+// Called from the UART receive interrupt. A complete frame is queued for
+// processMouseSamples(); it is dropped only if SAMPLE_MAX frames are queued.
 int8_t processSerialUnit(uint8_t data)
 {
     int8_t ready = 0;
@@ -311,7 +368,12 @@ int8_t processSerialUnit(uint8_t data)
     case 4:
         rawData.y |= data;
         rawData.count = 0;
-        processSerialData();
+        if (((sampleHead + 1) & (SAMPLE_MAX - 1)) == sampleTail) {
+            ++sampleDrops;
+            break;
+        }
+        samples[sampleHead] = rawData;
+        sampleHead = (sampleHead + 1) & (SAMPLE_MAX - 1);
         ready = 1;
         break;
     default:
@@ -341,7 +403,7 @@ int8_t getKeyboardMouseY(void)
 
 uint8_t getKeyboardMouseButtons(void)
 {
-    return isMouseTouched() ? (buttons & ~AIM_BUTTON) : 0;
+    return isMouseTouched() ? (buttons & ~(AIM_BUTTON | SCROLL_BUTTON)) : 0;
 }
 
 int8_t getKeyboardMouseWheel(void)
@@ -349,17 +411,87 @@ int8_t getKeyboardMouseWheel(void)
     return isMouseTouched() ? wheel : 0;
 }
 
-int8_t isProcessingSrialData(void)
+// Scroll the wheel for msec while a wheel key is held.
+void processMouseWheel(uint8_t msec)
 {
-    return 1 <= rawData.count;
+    uint16_t speed;
+
+    if (!isMouseTouched()) {
+        wheelHeld = 0;
+        wheelMotion = 0;
+        return;
+    }
+    if (!wheelKey)
+        return;
+    if (wheelHeld < WHEEL_ACCEL_MSEC) {
+        speed = WHEEL_SPEED_MIN + wheelHeld * (WHEEL_SPEED_MAX - WHEEL_SPEED_MIN) / WHEEL_ACCEL_MSEC;
+        wheelHeld += msec;
+    } else {
+        speed = WHEEL_SPEED_MAX;
+    }
+    // speed * msec / 1000 notches, rounding 1000 to 1024.
+    speed = (speed * msec) >> (10 - WHEEL_SHIFT);
+    if (0 < wheelKey)
+        wheelMotion += speed;
+    else
+        wheelMotion -= speed;
+}
+
+// Report the wheel in 1/multiplier notches; multiplier is either 1 or
+// WHEEL_MULTIPLIER. Called from the USB interrupt.
+void setMouseWheelResolution(uint8_t multiplier)
+{
+    wheelShift = (multiplier == WHEEL_MULTIPLIER) ? (WHEEL_SHIFT - WHEEL_MULTIPLIER_SHIFT) : WHEEL_SHIFT;
+}
+
+// Take the whole wheel steps accumulated so far.
+static void trimWheel(void)
+{
+    int16_t steps;
+
+    if (wheelMotion < 0)
+        steps = -((-wheelMotion) >> wheelShift);
+    else
+        steps = wheelMotion >> wheelShift;
+    wheel = clampXY(steps);
+    wheelMotion -= (int16_t) wheel << wheelShift;
+}
+
+// Process the frames queued by processSerialUnit() in a batch. The motion
+// of the batch is added up. Returns the number of frames processed.
+uint8_t processMouseSamples(void)
+{
+    uint8_t tail = sampleTail;
+    uint8_t n = 0;
+    int16_t sumX = 0;
+    int16_t sumY = 0;
+
+    while (tail != sampleHead) {
+        processSerialData(&samples[tail]);
+        sumX += x;
+        sumY += y;
+        tail = (tail + 1) & (SAMPLE_MAX - 1);
+        sampleTail = tail;
+        ++n;
+    }
+    if (1 < n) {
+        x = clampXY(sumX);
+        y = clampXY(sumY);
+    }
+    if (n)
+        trimWheel();
+    return n;
 }
 
 #ifdef WITH_HOS
 void processMouseData(void)
 {
-    rawData.x = HosGetKeyboardMouseX();
-    rawData.y = HosGetKeyboardMouseY();
-    rawData.touch = HosGetTouch();
-    processSerialData();
+    SerialData data;
+
+    data.x = HosGetKeyboardMouseX();
+    data.y = HosGetKeyboardMouseY();
+    data.touch = HosGetTouch();
+    processSerialData(&data);
+    trimWheel();
 }
 #endif
@@ -25,6 +25,17 @@
 #define PAD_SENSE_4     3
 #define PAD_SENSE_MAX   PAD_SENSE_4
 
+// The touch samples come in at (1 << PAD_SAMPLE_SHIFT) times the rate the
+// acceleration curves are made for; the pointer speed stays the same.
+#ifndef PAD_SAMPLE_SHIFT
+#define PAD_SAMPLE_SHIFT    0
+#endif
+
+// A wheel notch is split into WHEEL_MULTIPLIER steps once the host sets
+// the resolution multiplier feature of the mouse report descriptor.
+#define WHEEL_MULTIPLIER_SHIFT  3
+#define WHEEL_MULTIPLIER        (1u << WHEEL_MULTIPLIER_SHIFT)
+
 void initMouse(void);
 void loadMouseSettings(void);
 void emitMouse(void);
@@ -35,7 +46,9 @@ uint8_t getKeyboardMouseButtons(void);
 int8_t getKeyboardMouseX(void);
 int8_t getKeyboardMouseY(void);
 int8_t getKeyboardMouseWheel(void);
-int8_t isProcessingSrialData(void);
+uint8_t processMouseSamples(void);
+void processMouseWheel(uint8_t msec);
+void setMouseWheelResolution(uint8_t multiplier);
 
 #ifdef WITH_HOS
 void processMouseData(void);
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2026 Esrille Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Generated by tools/mousebench/mousebench -g; do not edit.
+
+#ifndef MOUSE_CURVE_H
+#define MOUSE_CURVE_H
+
+#include <stdint.h>
+
+// Pointer motion per sample by the offset from the centre. An entry with
+// MOUSE_CURVE_FRACTION holds the motion in 1/(1 << MOUSE_CURVE_SHIFT)
+// counts; otherwise the entry is the motion in counts.
+#define MOUSE_CURVE_FRACTION    0x80
+#define MOUSE_CURVE_SHIFT       7
+
+static const uint8_t mouseCurve2[256] = {  // x 2/3
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x8c, 0x8c, 0x8c, 0x8c, 0x8c, 0x8c, 0x8c, 0x8c,
+    0x8c, 0x8c, 0x8c, 0x97, 0x97, 0x97, 0x97, 0x97, 0x97, 0x97, 0x97, 0x97, 0xa3, 0xa3, 0xa3, 0xa3,
+    0xa3, 0xa3, 0xaf, 0xaf, 0xaf, 0xaf, 0xba, 0xba, 0xba, 0xba, 0xba, 0xc6, 0xc6, 0xc6, 0xd1, 0xd1,
+    0xd1, 0xdd, 0xdd, 0xdd, 0xe9, 0xe9, 0xe9, 0xf4, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+    0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+    0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x03, 0x03, 0x03, 0x03,
+    0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x05, 0x05,
+    0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05,
+    0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08,
+    0x08, 0x08, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0c, 0x0c,
+    0x0c, 0x0e, 0x0e, 0x0e, 0x0f, 0x0f, 0x0f, 0x0f, 0x0f, 0x0f, 0x0f, 0x0f, 0x0f, 0x0f, 0x0f, 0x12,
+    0x12, 0x12, 0x12, 0x12, 0x12, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x16, 0x16, 0x16, 0x17,
+    0x17, 0x17, 0x17, 0x17, 0x17, 0x17, 0x17, 0x17, 0x1b, 0x1b, 0x1b, 0x1b, 0x1b, 0x1b, 0x1b, 0x1b,
+    0x1b, 0x1c, 0x1c, 0x1c, 0x1f, 0x1f, 0x1f, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x21,
+    0x24, 0x24, 0x24, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x26, 0x26, 0x29, 0x2a, 0x2a, 0x2a, 0x2a,
+};
+
+static const uint8_t mouseCurve3[256] = {  // x 3/3
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x97, 0x97, 0x97, 0x97, 0x97, 0xa3, 0xa3, 0xa3,
+    0xa3, 0xaf, 0xaf, 0xaf, 0xba, 0xba, 0xba, 0xc6, 0xc6, 0xd1, 0xd1, 0xdd, 0xdd, 0xe9, 0xe9, 0xf4,
+    0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+    0x01, 0x01, 0x01, 0x01, 0x02, 0x02, 0x02, 0x02, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03,
+    0x03, 0x03, 0x03, 0x03, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05,
+    0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0b, 0x0b, 0x0b, 0x0b,
+    0x0b, 0x0b, 0x0b, 0x0b, 0x0c, 0x0c, 0x0e, 0x0e, 0x0f, 0x0f, 0x0f, 0x0f, 0x0f, 0x0f, 0x0f, 0x12,
+    0x12, 0x12, 0x12, 0x13, 0x13, 0x13, 0x13, 0x13, 0x16, 0x16, 0x17, 0x17, 0x17, 0x17, 0x17, 0x17,
+    0x1b, 0x1b, 0x1b, 0x1b, 0x1b, 0x1b, 0x1c, 0x1c, 0x1f, 0x1f, 0x20, 0x20, 0x20, 0x20, 0x20, 0x21,
+    0x24, 0x24, 0x25, 0x25, 0x25, 0x25, 0x26, 0x29, 0x2a, 0x2a, 0x2a, 0x2a, 0x2b, 0x2b, 0x2f, 0x2f,
+    0x2f, 0x2f, 0x30, 0x30, 0x34, 0x34, 0x35, 0x35, 0x35, 0x35, 0x3a, 0x3a, 0x3a, 0x3b, 0x3b, 0x3b,
+    0x40, 0x40, 0x40, 0x41, 0x41, 0x41, 0x46, 0x46, 0x46, 0x47, 0x47, 0x47, 0x4c, 0x4c, 0x4d, 0x4d,
+    0x4e, 0x4e, 0x53, 0x53, 0x53, 0x54, 0x54, 0x59, 0x5a, 0x5a, 0x5a, 0x5b, 0x60, 0x60, 0x61, 0x61,
+    0x62, 0x62, 0x67, 0x68, 0x68, 0x68, 0x69, 0x6e, 0x6f, 0x6f, 0x70, 0x70, 0x76, 0x76, 0x77, 0x77,
+    0x7d, 0x7d, 0x7e, 0x7e, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f,
+};
+
+static const uint8_t mouseCurve4[256] = {  // x 4/3
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xa3, 0xaf, 0xaf, 0xba, 0xba, 0xba, 0xc6, 0xd1,
+    0xd1, 0xdd, 0xe9, 0xe9, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+    0x01, 0x01, 0x01, 0x02, 0x02, 0x02, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x05,
+    0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08,
+    0x08, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0c, 0x0c, 0x0e, 0x0f, 0x0f, 0x0f, 0x0f, 0x0f, 0x0f,
+    0x12, 0x12, 0x12, 0x13, 0x13, 0x13, 0x16, 0x16, 0x17, 0x17, 0x17, 0x17, 0x1b, 0x1b, 0x1b, 0x1b,
+    0x1b, 0x1c, 0x1f, 0x1f, 0x20, 0x20, 0x20, 0x20, 0x24, 0x24, 0x25, 0x25, 0x25, 0x26, 0x2a, 0x2a,
+    0x2a, 0x2b, 0x2b, 0x2f, 0x2f, 0x2f, 0x30, 0x34, 0x34, 0x35, 0x35, 0x35, 0x3a, 0x3a, 0x3b, 0x3b,
+    0x40, 0x40, 0x40, 0x41, 0x41, 0x46, 0x46, 0x47, 0x47, 0x4c, 0x4c, 0x4d, 0x4e, 0x4e, 0x53, 0x53,
+    0x54, 0x54, 0x5a, 0x5a, 0x5a, 0x60, 0x60, 0x61, 0x62, 0x62, 0x67, 0x68, 0x68, 0x69, 0x6f, 0x6f,
+    0x70, 0x76, 0x76, 0x77, 0x7d, 0x7d, 0x7e, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f,
+    0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f,
+    0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f,
+    0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f,
+    0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f,
+};
+
+static const uint8_t mouseCurve5[256] = {  // x 5/3
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc6, 0xd1, 0xdd, 0xe9, 0xe9, 0x01, 0x01, 0x01,
+    0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x02, 0x02, 0x02, 0x03, 0x03, 0x03, 0x03,
+    0x03, 0x03, 0x03, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08,
+    0x08, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0c, 0x0e, 0x0f, 0x0f, 0x0f, 0x0f, 0x0f, 0x12, 0x12, 0x13,
+    0x13, 0x13, 0x16, 0x17, 0x17, 0x17, 0x17, 0x1b, 0x1b, 0x1b, 0x1c, 0x1c, 0x1f, 0x20, 0x20, 0x20,
+    0x24, 0x24, 0x25, 0x25, 0x26, 0x2a, 0x2a, 0x2a, 0x2b, 0x2f, 0x2f, 0x30, 0x34, 0x34, 0x35, 0x35,
+    0x3a, 0x3a, 0x3b, 0x3b, 0x40, 0x41, 0x41, 0x46, 0x46, 0x47, 0x47, 0x4c, 0x4d, 0x4e, 0x53, 0x53,
+    0x54, 0x59, 0x5a, 0x5a, 0x60, 0x60, 0x61, 0x62, 0x67, 0x68, 0x69, 0x6e, 0x6f, 0x70, 0x76, 0x77,
+    0x7d, 0x7d, 0x7e, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f,
+    0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f,
+    0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f,
+    0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f,
+    0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f,
+    0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f,
+    0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f,
+};
+
+static const uint8_t mouseCurve6[256] = {  // x 6/3
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+    0x01, 0x01, 0x02, 0x02, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05,
+    0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0b, 0x0b, 0x0b, 0x0b, 0x0c, 0x0e, 0x0f, 0x0f, 0x0f, 0x0f,
+    0x12, 0x12, 0x13, 0x13, 0x16, 0x17, 0x17, 0x17, 0x1b, 0x1b, 0x1b, 0x1c, 0x1f, 0x20, 0x20, 0x20,
+    0x24, 0x25, 0x25, 0x26, 0x2a, 0x2a, 0x2b, 0x2f, 0x2f, 0x30, 0x34, 0x35, 0x35, 0x3a, 0x3a, 0x3b,
+    0x40, 0x40, 0x41, 0x46, 0x46, 0x47, 0x4c, 0x4d, 0x4e, 0x53, 0x53, 0x54, 0x5a, 0x5a, 0x60, 0x61,
+    0x62, 0x67, 0x68, 0x69, 0x6f, 0x70, 0x76, 0x77, 0x7d, 0x7e, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f,
+    0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f,
+    0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f,
+    0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f,
+    0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f,
+    0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f,
+    0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f,
+    0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f,
+    0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f,
+};
+
+#endif  // #ifndef MOUSE_CURVE_H
@@ -63,7 +63,7 @@
 //Value provided is expected to be in the format of BOOTLOADER_VERSION_MAJOR.BOOTLOADER_VERSION_MINOR
 //Ex: 1.01 would be BOOTLOADER_VERSION_MAJOR == 1, and BOOTLOADER_VERSION_MINOR == 1
 #define BOOTLOADER_VERSION_MAJOR         1 //Legal value 0-255
-#define BOOTLOADER_VERSION_MINOR         2 //Legal value 0-99.  (1 = X.01)
+#define BOOTLOADER_VERSION_MINOR         3 //Legal value 0-99.  (1 = X.01)
 
 
 //Section defining the address range to erase for the erase device command, along with the valid programming range to be reported by the QUERY_DEVICE command.
@@ -190,6 +190,11 @@
 #define SIGN_FLASH                  0x09    //The host PC application should send this command after the verify operation has completed successfully.  If checksums are used instead of a true verify (due to ALLOW_GET_DATA_COMMAND being commented), then the host PC application should send SIGN_FLASH command after is has verified the checksums are as exected. The firmware will then program the SIGNATURE_WORD into flash at the SIGNATURE_ADDRESS.
 #define QUERY_EXTENDED_INFO         0x0C    //Used by host PC app to get additional info about the device, beyond the basic NVM layout provided by the query device command
 
+//Esrille New Keyboard: commands for rewriting only the erase pages that differ from the new image (version 1.03 or later)
+#define GET_CHECKSUMS               0x10    //Returns the CRC-16 of up to CHECKSUM_MAX_BLOCKS consecutive memory blocks, so the host can find the pages that differ without reading them out with GET_DATA.
+#define LOAD_PAGE                   0x11    //Same packet format as PROGRAM_DEVICE.  Copies the data into the page buffer at the offset of the address within its erase page.  The buffer starts out blank (0xFF) for each new page.
+#define WRITE_PAGE                  0x12    //Erases the erase page at the address, and programs the whole loaded page buffer into it with full block writes.  LOAD_PAGE and PROGRAM_DEVICE must not be mixed, since they share the buffer.
+
 //Unlock Configs Command Definitions
 #define UNLOCKCONFIG                0x00    //Sub-command for the ERASE_DEVICE command
 #define LOCKCONFIG                  0x01    //Sub-command for the ERASE_DEVICE command
@@ -217,6 +222,7 @@
 #define WORDSIZE                    0x02    //PIC18 uses 2 byte words, PIC24 uses 3 byte words.
 #define REQUEST_DATA_BLOCK_SIZE     0x3A    //Number of data bytes in a standard request to the PC.  Must be an even number from 2-58 (0x02-0x3A).  Larger numbers make better use of USB bandwidth and 
                                             //yeild shorter program/verify times, but require more micrcontroller RAM for buffer space.
+#define CHECKSUM_MAX_BLOCKS         28      //Number of checksums that fit in a GET_CHECKSUMS response packet
 
 
 
@@ -289,6 +295,15 @@ typedef union
             unsigned char Config7LMask;
             unsigned char Config7HMask;
         };          
+
+        //Structure for the GET_CHECKSUMS command (and response)
+        struct{
+            unsigned char Command;
+            unsigned long Address;
+            unsigned char BlockCount;
+            unsigned int BlockLength;
+            unsigned int Checksum[CHECKSUM_MAX_BLOCKS];
+        };
 } PacketToFromPC;       
     
 
@@ -313,6 +328,7 @@ unsigned int ErasePageTracker;
 unsigned char BufferedDataIndex;
 uint24_t ProgrammedPointer;
 unsigned char ConfigsLockValue;
+uint24_t LoadedPage;
 
 
 /** P R I V A T E  P R O T O T Y P E S ***************************************/
@@ -323,6 +339,8 @@ void UnlockAndActivate(unsigned char UnlockKey);
 void ResetDeviceCleanly(void);
 void TableReadPostIncrement(void);
 void SignFlash(void);
+void WriteFlashPage(void);
+unsigned int ChecksumBlock(uint24_t Address, unsigned int Length);
 void LowVoltageCheck(void);
 
 
@@ -337,6 +355,7 @@ void UserInit(void)
     ProgrammedPointer = INVALID_ADDRESS;    
     BufferedDataIndex = 0;
     ConfigsLockValue = TRUE;
+    LoadedPage = INVALID_ADDRESS;
 }//end UserInit
 
 /******************************************************************************
@@ -558,6 +577,56 @@ void ProcessIO(void)
                 break;
             case SIGN_FLASH:
                 SignFlash();
+                LoadedPage = INVALID_ADDRESS;   //SignFlash() used the page buffer
+                BootState = IDLE;
+                break;
+            case GET_CHECKSUMS:
+                //The response packet was cleared when the command arrived, so
+                //compute the checksums only once even if the IN endpoint is busy.
+                if(PacketToPC.Command != GET_CHECKSUMS)
+                {
+                    PacketToPC.Command = GET_CHECKSUMS;
+                    PacketToPC.Address = PacketFromPC.Address;
+                    PacketToPC.BlockCount = PacketFromPC.BlockCount;
+                    if(PacketToPC.BlockCount > CHECKSUM_MAX_BLOCKS)
+                        PacketToPC.BlockCount = CHECKSUM_MAX_BLOCKS;
+                    PacketToPC.BlockLength = PacketFromPC.BlockLength;
+                    for(i = 0; i < PacketToPC.BlockCount; i++)
+                    {
+                        ClearWatchdog();
+                        PacketToPC.Checksum[i] = ChecksumBlock((uint24_t)PacketFromPC.Address + (uint24_t)i * PacketFromPC.BlockLength, PacketFromPC.BlockLength);
+                        USBDeviceTasks();     //Call USBDeviceTasks() periodically to prevent falling off the bus if any SETUP packets should happen to arrive.
+                    }
+                }
+                if(!mHIDTxIsBusy())
+                {
+                    HIDTxReport((char *)&PacketToPC, USB_PACKET_SIZE);
+                    BootState = IDLE;
+                }
+                break;
+            case LOAD_PAGE:
+                if(LoadedPage != (uint24_t)(PacketFromPC.Address & ERASE_PAGE_ADDRESS_MASK))
+                {
+                    LoadedPage = (uint24_t)(PacketFromPC.Address & ERASE_PAGE_ADDRESS_MASK);
+                    for(i = 0; i < ERASE_PAGE_SIZE; i++)
+                        ProgrammingBuffer[i] = 0xFF;
+                }
+                if(PacketFromPC.Size <= REQUEST_DATA_BLOCK_SIZE && (PacketFromPC.Address & ~ERASE_PAGE_ADDRESS_MASK) + PacketFromPC.Size <= ERASE_PAGE_SIZE)
+                {
+                    for(i = 0; i < PacketFromPC.Size; i++)
+                    {
+                        ProgrammingBuffer[(PacketFromPC.Address & ~ERASE_PAGE_ADDRESS_MASK) + i] = PacketFromPC.Data[i+(REQUEST_DATA_BLOCK_SIZE-PacketFromPC.Size)];    //Data field is right justified, as in PROGRAM_DEVICE.
+                    }
+                }
+                BootState = IDLE;
+                break;
+            case WRITE_PAGE:
+                //Only the page the buffer was loaded for can be written.
+                if(LoadedPage == (uint24_t)(PacketFromPC.Address & ERASE_PAGE_ADDRESS_MASK))
+                {
+                    WriteFlashPage();
+                }
+                LoadedPage = INVALID_ADDRESS;
                 BootState = IDLE;
                 break;
             case QUERY_EXTENDED_INFO:
@@ -867,6 +936,79 @@ void WriteConfigBits(void)  //Also used to write the Device ID
     }
 }
 
+//Erases the page at LoadedPage, and programs the whole ProgrammingBuffer[]
+//into it with WRITE_BLOCK_SIZE block writes.
+void WriteFlashPage(void)
+{
+    static unsigned char i;
+
+    //Never touch the bootloader itself
+    if(((LoadedPage / ERASE_PAGE_SIZE) < START_PAGE_TO_ERASE) || ((LoadedPage / ERASE_PAGE_SIZE) > MAX_PAGE_TO_ERASE))
+        return;
+
+    #ifdef __XC8__
+        TBLPTRU = LoadedPage >> 16;
+        TBLPTRH = LoadedPage >> 8;
+        TBLPTRL = (uint8_t)LoadedPage;
+    #else
+        TBLPTR = LoadedPage;
+    #endif
+    EECON1 = 0b10010100;    //Prepare for erasing flash memory
+    UnlockAndActivate(CORRECT_UNLOCK_KEY);
+
+    for(i = 0; i < ERASE_PAGE_SIZE; i++)
+    {
+        TABLAT = ProgrammingBuffer[i];
+        #ifdef __XC8__
+            #asm
+                tblwtpostinc
+            #endasm
+        #else //must be C18 instead
+            _asm tblwtpostinc _endasm
+        #endif
+
+        if((i % WRITE_BLOCK_SIZE) == (WRITE_BLOCK_SIZE - 1))
+        {
+            //The write latches are full.  Point TBLPTR back into the block,
+            //program it, and move on to the next block.
+            #ifdef __XC8__
+                #asm
+                    tblrdpostdec
+                #endasm
+            #else //must be C18 instead
+                _asm tblrdpostdec _endasm
+            #endif
+            ClearWatchdog();
+            EECON1 = 0b10100100;    //flash programming mode
+            UnlockAndActivate(CORRECT_UNLOCK_KEY);
+            TableReadPostIncrement();
+        }
+    }
+}
+
+
+//Returns the CRC-16 (CCITT polynomial 0x1021, initial value 0xFFFF) of Length
+//bytes of memory from Address.  The host flashing tool computes the same CRC
+//over the new image.
+unsigned int ChecksumBlock(uint24_t Address, unsigned int Length)
+{
+    static unsigned int crc;
+    static ROM uint8_t* pROM;
+
+    crc = 0xFFFF;
+    pROM = (ROM uint8_t*)Address;
+    while(Length--)
+    {
+        crc = (crc >> 8) | (crc << 8);
+        crc ^= *pROM++;
+        crc ^= (unsigned char)crc >> 4;
+        crc ^= crc << 12;
+        crc ^= (crc & 0xFF) << 5;
+    }
+    return crc;
+}
+
+
 #if defined(DEVICE_WITH_EEPROM)
 void WriteEEPROM(void)
 {
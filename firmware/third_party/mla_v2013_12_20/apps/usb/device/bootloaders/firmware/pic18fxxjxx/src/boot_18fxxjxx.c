@@ -57,7 +57,7 @@
 //Value provided is expected to be in the format of BOOTLOADER_VERSION_MAJOR.BOOTLOADER_VERSION_MINOR
 //Ex: 1.01 would be BOOTLOADER_VERSION_MAJOR == 1, and BOOTLOADER_VERSION_MINOR == 1
 #define BOOTLOADER_VERSION_MAJOR         1 //Legal value 0-255
-#define BOOTLOADER_VERSION_MINOR         2 //Legal value 0-99.  (1 = X.01)
+#define BOOTLOADER_VERSION_MINOR         3 //Legal value 0-99.  (1 = X.01)
 
 //First address of the application program memory region.
 #define PROGRAM_MEM_START_ADDRESS       (uint32_t)REMAPPED_APPLICATION_RESET_VECTOR      //Beginning of application program memory (not occupied by bootloader).  If changing this value, this address must be aligned with the start of a flash memory erase page.
@@ -133,6 +133,11 @@
 #define SIGN_FLASH                  0x09    //The host PC application should send this command after the verify operation has completed successfully.  If checksums are used instead of a true verify (due to ALLOW_GET_DATA_COMMAND being commented), then the host PC application should send SIGN_FLASH command after is has verified the checksums are as exected. The firmware will then program the SIGNATURE_WORD into flash at the SIGNATURE_ADDRESS.
 #define QUERY_EXTENDED_INFO         0x0C    //Used by host PC app to get additional info about the device, beyond the basic NVM layout provided by the query device command
 
+//Esrille New Keyboard: commands for rewriting only the erase pages that differ from the new image (version 1.03 or later)
+#define GET_CHECKSUMS               0x10    //Returns the CRC-16 of up to CHECKSUM_MAX_BLOCKS consecutive memory blocks, so the host can find the pages that differ without reading them out with GET_DATA.
+#define LOAD_PAGE                   0x11    //Same packet format as PROGRAM_DEVICE.  Copies the data into the page buffer at the offset of the address within its erase page.  The buffer starts out blank (0xFF) for each new page.
+#define WRITE_PAGE                  0x12    //Erases the erase page at the address, and programs the whole loaded page buffer into it with full block writes.  LOAD_PAGE and PROGRAM_DEVICE must not be mixed, since they share the buffer.
+
 //Unlock Configs Command Definitions
 #define UNLOCKCONFIG                0x00    //Sub-command for the ERASE_DEVICE command
 #define LOCKCONFIG                  0x01    //Sub-command for the ERASE_DEVICE command
@@ -160,6 +165,7 @@
 #define WORDSIZE                    0x02    //PIC18 uses 2 byte words, PIC24 uses 3 byte words.
 #define REQUEST_DATA_BLOCK_SIZE     0x3A    //Number of data bytes in a standard request to the PC.  Must be an even number from 2-58 (0x02-0x3A).  Larger numbers make better use of USB bandwidth and
                                             //yeild shorter program/verify times, but require more micrcontroller RAM for buffer space.
+#define CHECKSUM_MAX_BLOCKS         28      //Number of checksums that fit in a GET_CHECKSUMS response packet
 
 
 
@@ -234,6 +240,15 @@ typedef union
             unsigned char Config8LMask;
             unsigned char Config8HMask;
         };
+
+        //Structure for the GET_CHECKSUMS command (and response)
+        struct{
+            unsigned char Command;
+            unsigned long Address;
+            unsigned char BlockCount;
+            unsigned int BlockLength;
+            unsigned int Checksum[CHECKSUM_MAX_BLOCKS];
+        };
 } PacketToFromPC;
 
 
@@ -258,6 +273,7 @@ uint24_t ProgramMemStopAddress;
 unsigned char BootState;
 signed char BufferedDataIndex;
 uint24_t ProgrammedPointer;
+uint24_t LoadedPage;
 
 
 /** P R I V A T E  P R O T O T Y P E S ***************************************/
@@ -267,6 +283,8 @@ void ResetDeviceCleanly(void);
 void TableReadPostIncrement(void);
 void SignFlash(void);
 void EraseFlashPage(unsigned int PageNumToErase);
+void WriteFlashPage(void);
+unsigned int ChecksumBlock(uint24_t Address, unsigned int Length);
 void LowVoltageCheck(void);
 
 
@@ -282,6 +300,7 @@ void UserInit(void)
     BootState = IDLE;
     ProgrammedPointer = INVALID_ADDRESS;
     BufferedDataIndex = 0;
+    LoadedPage = INVALID_ADDRESS;
 }//end UserInit
 
 
@@ -454,6 +473,56 @@ void ProcessIO(void)
                 break;
             case SIGN_FLASH:
                 SignFlash();
+                LoadedPage = INVALID_ADDRESS;   //SignFlash() used the page buffer
+                BootState = IDLE;
+                break;
+            case GET_CHECKSUMS:
+                //The response packet was cleared when the command arrived, so
+                //compute the checksums only once even if the IN endpoint is busy.
+                if(PacketToPC.Command != GET_CHECKSUMS)
+                {
+                    PacketToPC.Command = GET_CHECKSUMS;
+                    PacketToPC.Address = PacketFromPC.Address;
+                    PacketToPC.BlockCount = PacketFromPC.BlockCount;
+                    if(PacketToPC.BlockCount > CHECKSUM_MAX_BLOCKS)
+                        PacketToPC.BlockCount = CHECKSUM_MAX_BLOCKS;
+                    PacketToPC.BlockLength = PacketFromPC.BlockLength;
+                    for(i = 0; i < PacketToPC.BlockCount; i++)
+                    {
+                        ClearWatchdog();
+                        PacketToPC.Checksum[i] = ChecksumBlock((uint24_t)PacketFromPC.Address + (uint24_t)i * PacketFromPC.BlockLength, PacketFromPC.BlockLength);
+                        USBDeviceTasks();     //Call USBDeviceTasks() periodically to prevent falling off the bus if any SETUP packets should happen to arrive.
+                    }
+                }
+                if(!mHIDTxIsBusy())
+                {
+                    HIDTxReport((char *)&PacketToPC, USB_PACKET_SIZE);
+                    BootState = IDLE;
+                }
+                break;
+            case LOAD_PAGE:
+                if(LoadedPage != (uint24_t)(PacketFromPC.Address & ERASE_PAGE_ADDRESS_MASK))
+                {
+                    LoadedPage = (uint24_t)(PacketFromPC.Address & ERASE_PAGE_ADDRESS_MASK);
+                    for(i = 0; i < ERASE_PAGE_SIZE; i++)
+                        ProgrammingBuffer[i] = 0xFF;
+                }
+                if(PacketFromPC.Size <= REQUEST_DATA_BLOCK_SIZE && (PacketFromPC.Address & ~ERASE_PAGE_ADDRESS_MASK) + PacketFromPC.Size <= ERASE_PAGE_SIZE)
+                {
+                    for(i = 0; i < PacketFromPC.Size; i++)
+                    {
+                        ProgrammingBuffer[(PacketFromPC.Address & ~ERASE_PAGE_ADDRESS_MASK) + i] = PacketFromPC.Data[i+(REQUEST_DATA_BLOCK_SIZE-PacketFromPC.Size)];    //Data field is right justified, as in PROGRAM_DEVICE.
+                    }
+                }
+                BootState = IDLE;
+                break;
+            case WRITE_PAGE:
+                //Only the page the buffer was loaded for can be written.
+                if(LoadedPage == (uint24_t)(PacketFromPC.Address & ERASE_PAGE_ADDRESS_MASK))
+                {
+                    WriteFlashPage();
+                }
+                LoadedPage = INVALID_ADDRESS;
                 BootState = IDLE;
                 break;
             case QUERY_EXTENDED_INFO:
@@ -742,6 +811,105 @@ void EraseFlashPage(unsigned int PageNumToErase)
 }
 
 
+//Erases the page at LoadedPage, and programs the whole ProgrammingBuffer[]
+//into it.  Full WRITE_BLOCK_SIZE block writes take about as long as a single
+//word write, so this is much faster than WriteFlashSubBlock().
+void WriteFlashPage(void)
+{
+    static unsigned int i;
+
+    //Never touch the bootloader itself, nor the config words page unless the
+    //host has unlocked it.
+    i = (unsigned int)(LoadedPage / ERASE_PAGE_SIZE);
+    if((i < START_PAGE_TO_ERASE) || (i > MaxPageToErase))
+        return;
+    EraseFlashPage(i);
+
+    #ifdef __XC8__
+        TBLPTRU = LoadedPage >> 16;
+        TBLPTRH = LoadedPage >> 8;
+        TBLPTRL = (uint8_t)LoadedPage;
+    #else
+        TBLPTR = LoadedPage;
+    #endif
+    for(i = 0; i < ERASE_PAGE_SIZE; i++)
+    {
+        TABLAT = ProgrammingBuffer[i];
+        #ifdef __XC8__
+            #asm
+                tblwtpostinc
+            #endasm
+        #else //must be C18 instead
+            _asm tblwtpostinc _endasm
+        #endif
+
+        if((i % WRITE_BLOCK_SIZE) == (WRITE_BLOCK_SIZE - 1))
+        {
+            //The write latches are full.  Point TBLPTR back into the block,
+            //program it, and move on to the next block.
+            #ifdef __XC8__
+                #asm
+                    tblrdpostdec
+                #endasm
+            #else //must be C18 instead
+                _asm tblrdpostdec _endasm
+            #endif
+            ClearWatchdog();
+            EECON1 = 0b00000100;    //Block write mode
+            UnlockAndActivate(CORRECT_UNLOCK_KEY);
+            #ifdef __XC8__
+                #asm
+                    tblrdpostinc
+                #endasm
+            #else //must be C18 instead
+                _asm tblrdpostinc _endasm
+            #endif
+        }
+    }
+}
+
+
+//Returns the CRC-16 (CCITT polynomial 0x1021, initial value 0xFFFF) of Length
+//bytes of memory from Address.  The host flashing tool computes the same CRC
+//over the new image.
+unsigned int ChecksumBlock(uint24_t Address, unsigned int Length)
+{
+    static unsigned int crc;
+    #ifndef __XC8__
+        static far ROM uint8_t* pROM;
+    #endif
+
+    crc = 0xFFFF;
+    #ifdef __XC8__
+        TBLPTRU = Address >> 16;
+        TBLPTRH = Address >> 8;
+        TBLPTRL = (uint8_t)Address;
+        while(Length--)
+        {
+            #asm
+                tblrdpostinc
+            #endasm
+            crc = (crc >> 8) | (crc << 8);
+            crc ^= TABLAT;
+            crc ^= (unsigned char)crc >> 4;
+            crc ^= crc << 12;
+            crc ^= (crc & 0xFF) << 5;
+        }
+    #else
+        pROM = (far ROM uint8_t*)Address;
+        while(Length--)
+        {
+            crc = (crc >> 8) | (crc << 8);
+            crc ^= *pROM++;
+            crc ^= (unsigned char)crc >> 4;
+            crc ^= crc << 12;
+            crc ^= (crc & 0xFF) << 5;
+        }
+    #endif
+    return crc;
+}
+
+
 
 
 /** EOF boot_18fxxjxx.c *********************************************************/
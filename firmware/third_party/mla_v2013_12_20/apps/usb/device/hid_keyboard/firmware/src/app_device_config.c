@@ -0,0 +1,175 @@
+/*
+ * Copyright 2026 Esrille Inc.
+ *
+ * This file is a modified version of app_device_mouse.c provided by
+ * Microchip Technology, Inc. for using Esrille New Keyboard.
+ * See the file NOTICE for copying permission.
+ */
+
+/********************************************************************
+ Software License Agreement:
+
+ The software supplied herewith by Microchip Technology Incorporated
+ (the "Company") for its PIC(R) Microcontroller is intended and
+ supplied to you, the Company's customer, for use solely and
+ exclusively on Microchip PIC Microcontroller products. The
+ software is owned by the Company and/or its supplier, and is
+ protected under applicable copyright laws. All rights are reserved.
+ Any use in violation of the foregoing restrictions may subject the
+ user to criminal sanctions under applicable laws, as well as to
+ civil liability for the breach of the terms and conditions of this
+ license.
+
+ THIS SOFTWARE IS PROVIDED IN AN "AS IS" CONDITION. NO WARRANTIES,
+ WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+ TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. THE COMPANY SHALL NOT,
+ IN ANY CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL OR
+ CONSEQUENTIAL DAMAGES, FOR ANY REASON WHATSOEVER.
+********************************************************************/
+
+/** INCLUDES *******************************************************/
+#include <system.h>
+
+#include <stdint.h>
+#include <string.h>
+
+#include <usb/usb.h>
+#include <usb/usb_device.h>
+#include <usb/usb_device_hid.h>
+
+#include <app_device_config.h>
+#include <usb_config.h>
+
+#include "Keyboard.h"
+#include "Mouse.h"
+
+/*******************************************************************************
+ * Report Data Types - the settings of every profile, EEPROM_BASE to
+ * EEPROM_PREFIX each, go in one report so that a keyboard is read or
+ * provisioned in a single control transfer.  The profiles beyond
+ * NVRAM_PROFILE_MAX are zero and ignored.
+ ******************************************************************************/
+typedef struct __attribute__((packed))
+{
+    uint8_t id;             // CONFIG_REPORT_SETTINGS
+    uint8_t version;        // CONFIG_VERSION; read only
+    uint8_t status;         // CONFIG_OK, etc.; read only
+    uint8_t profiles;       // NVRAM_PROFILE_MAX; read only
+    uint8_t current;        // the current profile; 0xff to keep it
+    uint8_t size;           // EEPROM_SETTINGS; read only
+    uint8_t settings[CONFIG_PROFILE_MAX][EEPROM_SETTINGS];
+} CONFIG_SETTINGS;
+
+static CONFIG_SETTINGS settingsReport;
+static volatile uint8_t status;
+
+static void readSettings(void)
+{
+    memset(&settingsReport, 0, sizeof settingsReport);
+    settingsReport.id = CONFIG_REPORT_SETTINGS;
+    settingsReport.version = CONFIG_VERSION;
+    settingsReport.status = status;
+    settingsReport.profiles = NVRAM_PROFILE_MAX;
+    settingsReport.current = CurrentProfile();
+    settingsReport.size = EEPROM_SETTINGS;
+#if NVRAM_PROFILE_MAX == 1
+    for (uint8_t i = 0; i < EEPROM_SETTINGS; ++i)
+        settingsReport.settings[0][i] = ReadNvram(i);
+#else
+    ReadNvramProfiles(settingsReport.settings[0], EEPROM_SETTINGS);
+#endif
+}
+
+static uint8_t writeSettings(void)
+{
+    for (uint8_t p = 0; p < NVRAM_PROFILE_MAX; ++p) {
+        if (!checkSettings(settingsReport.settings[p]))
+            return CONFIG_REJECTED;
+    }
+#if NVRAM_PROFILE_MAX == 1
+    for (uint8_t i = 0; i < EEPROM_SETTINGS; ++i) {
+        if (ReadNvram(i) != settingsReport.settings[0][i])
+            WriteNvram(i, settingsReport.settings[0][i]);
+    }
+#else
+    WriteNvramProfiles(settingsReport.settings[0], EEPROM_SETTINGS, settingsReport.current);
+#endif
+    loadKeyboardSettings();
+#ifdef ENABLE_MOUSE
+    loadMouseSettings();
+#endif
+    return CONFIG_OK;
+}
+
+static void APP_DeviceConfigSetReportComplete(void)
+{
+    status = CONFIG_BUSY;
+}
+
+/*********************************************************************
+* Function: void APP_DeviceConfigTasks(void);
+*
+* Overview: Writes the settings received by SET_REPORT and loads them.
+*   The flash or EEPROM is written here rather than in the USB interrupt.
+*
+* PreCondition: None
+*
+* Input: None
+*
+* Output: None
+*
+********************************************************************/
+void APP_DeviceConfigTasks(void)
+{
+    if (status != CONFIG_BUSY)
+        return;
+    status = writeSettings();
+}
+
+/*********************************************************************
+* Function: void APP_DeviceConfigGetReportHandler(void);
+*
+* Overview: Answers GET_REPORT(FEATURE) for the settings report.  While
+*   the last settings are being written, only the status is valid.
+*
+* PreCondition: The request is for HID_TELEMETRY_INTF_ID.
+*
+* Input: None
+*
+* Output: None
+*
+********************************************************************/
+void APP_DeviceConfigGetReportHandler(void)
+{
+    if (SetupPkt.W_Value.byte.HB != 0x03 || SetupPkt.W_Value.byte.LB != CONFIG_REPORT_SETTINGS)
+        return;
+    if (status != CONFIG_BUSY)
+        readSettings();
+    else
+        settingsReport.status = CONFIG_BUSY;
+    USBEP0SendRAMPtr((uint8_t*) &settingsReport, sizeof settingsReport, USB_EP0_INCLUDE_ZERO);
+}
+
+/*********************************************************************
+* Function: void APP_DeviceConfigSetReportHandler(void);
+*
+* Overview: Receives SET_REPORT(FEATURE) for the settings report unless
+*   the last settings are still being written.  Requests of any other
+*   length are left unclaimed so that they are stalled.
+*
+* PreCondition: The request is for HID_TELEMETRY_INTF_ID.
+*
+* Input: None
+*
+* Output: None
+*
+********************************************************************/
+void APP_DeviceConfigSetReportHandler(void)
+{
+    if (SetupPkt.W_Value.byte.HB != 0x03 || SetupPkt.W_Value.byte.LB != CONFIG_REPORT_SETTINGS)
+        return;
+    if (status == CONFIG_BUSY || SetupPkt.wLength != sizeof settingsReport)
+        return;
+    USBEP0Receive((uint8_t*) &settingsReport, sizeof settingsReport, APP_DeviceConfigSetReportComplete);
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2026 Esrille Inc.
+ *
+ * This file is a modified version of app_device_mouse.h provided by
+ * Microchip Technology, Inc. for using Esrille New Keyboard.
+ * See the file NOTICE for copying permission.
+ */
+
+/********************************************************************
+ Software License Agreement:
+
+ The software supplied herewith by Microchip Technology Incorporated
+ (the "Company") for its PIC(R) Microcontroller is intended and
+ supplied to you, the Company's customer, for use solely and
+ exclusively on Microchip PIC Microcontroller products. The
+ software is owned by the Company and/or its supplier, and is
+ protected under applicable copyright laws. All rights are reserved.
+ Any use in violation of the foregoing restrictions may subject the
+ user to criminal sanctions under applicable laws, as well as to
+ civil liability for the breach of the terms and conditions of this
+ license.
+
+ THIS SOFTWARE IS PROVIDED IN AN "AS IS" CONDITION. NO WARRANTIES,
+ WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+ TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. THE COMPANY SHALL NOT,
+ IN ANY CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL OR
+ CONSEQUENTIAL DAMAGES, FOR ANY REASON WHATSOEVER.
+ *******************************************************************/
+
+#ifndef APP_DEVICE_CONFIG_H
+#define APP_DEVICE_CONFIG_H
+
+#include <usb/usb_device.h>
+#include <usb/usb_device_hid.h>
+
+// The settings FEATURE report on the vendor defined interface
+#define CONFIG_VERSION          1
+#define CONFIG_REPORT_SETTINGS  3
+#define CONFIG_PROFILE_MAX      4   // profiles in the report
+#define CONFIG_REPORT_SIZE      (5 + CONFIG_PROFILE_MAX * 9)    // without the report ID; 9 for EEPROM_SETTINGS
+
+// status
+#define CONFIG_OK               0
+#define CONFIG_BUSY             1   // the last settings are being written
+#define CONFIG_REJECTED         2   // the last settings had a field out of range
+
+/*********************************************************************
+* Function: void APP_DeviceConfigTasks(void);
+*
+* Overview: Writes the settings received by SET_REPORT and loads them.
+*
+* PreCondition: None
+*
+* Input: None
+*
+* Output: None
+*
+********************************************************************/
+void APP_DeviceConfigTasks(void);
+
+/*********************************************************************
+* Function: void APP_DeviceConfigGetReportHandler(void);
+*
+* Overview: Answers GET_REPORT(FEATURE) for the settings report.
+*
+* PreCondition: The request is for HID_TELEMETRY_INTF_ID.
+*
+* Input: None
+*
+* Output: None
+*
+********************************************************************/
+void APP_DeviceConfigGetReportHandler(void);
+
+/*********************************************************************
+* Function: void APP_DeviceConfigSetReportHandler(void);
+*
+* Overview: Receives SET_REPORT(FEATURE) for the settings report.
+*
+* PreCondition: The request is for HID_TELEMETRY_INTF_ID.
+*
+* Input: None
+*
+* Output: None
+*
+********************************************************************/
+void APP_DeviceConfigSetReportHandler(void);
+
+#endif
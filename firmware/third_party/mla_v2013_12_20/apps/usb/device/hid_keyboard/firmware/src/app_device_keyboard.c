@@ -62,11 +62,22 @@ SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
 
 #include "app_device_keyboard.h"
 #include "app_device_cc.h"
+#include "app_device_mouse.h"
+#include "app_device_telemetry.h"
+#include "app_device_config.h"
 #include "app_led_usb_status.h"
 
 #include <Keyboard.h>
 
 #define SCAN_DELAY  (_XTAL_FREQ / 256 / 4 / 167 + 1) // About 6 [msec]
+#define IDLE_UNIT   (_XTAL_FREQ / 256 / 4 / 250)     // 4 [msec] of SET_IDLE
+#define REPORT_QUEUE_SIZE   8                       // must be a power of 2
+
+#ifdef USB_SOF_SYNC
+#define FRAME_COUNTS    (_XTAL_FREQ / 256 / 4 / 1000)   // 1 [msec]
+#define SCAN_FRAMES     6                               // as SCAN_DELAY
+#define SCAN_GUARD      2                               // [Timer0 counts]
+#endif
 
 // *****************************************************************************
 // *****************************************************************************
@@ -258,6 +269,12 @@ typedef struct
 {
     USB_HANDLE lastINTransmission;
     USB_HANDLE lastOUTTransmission;
+    uint8_t nextSlot;       // reportSlots[] to be filled next
+    uint8_t head;           // reportQueue[] to be sent next
+    uint8_t count;          // reports in reportQueue[]
+    uint16_t loaded;        // Timer0 count when the last report was loaded
+    uint16_t scanned;       // Timer0 count when the last report was scanned
+    bool waiting;           // the last report is waiting for its IN token
 } KEYBOARD;
 
 // *****************************************************************************
@@ -270,7 +287,17 @@ static KEYBOARD keyboard;
 #if !defined(KEYBOARD_INPUT_REPORT_DATA_BUFFER_ADDRESS_TAG)
     #define KEYBOARD_INPUT_REPORT_DATA_BUFFER_ADDRESS_TAG
 #endif
-static KEYBOARD_INPUT_REPORT inputReport KEYBOARD_INPUT_REPORT_DATA_BUFFER_ADDRESS_TAG;
+/* The keyboard engine builds inputReport; copies of it wait in reportQueue[]
+ * until one of the two ping-pong buffers of the endpoint is free, and are
+ * then handed over to the USB module in reportSlots[] in order. */
+static KEYBOARD_INPUT_REPORT inputReport;
+static KEYBOARD_INPUT_REPORT reportQueue[REPORT_QUEUE_SIZE];
+static uint16_t reportStamps[REPORT_QUEUE_SIZE];   // Timer0 counts when scanned
+static KEYBOARD_INPUT_REPORT reportSlots[2] KEYBOARD_INPUT_REPORT_DATA_BUFFER_ADDRESS_TAG;
+static APP_KEYBOARD_STATS stats;
+static APP_KEYBOARD_STARTUP startup;
+static uint32_t uptime;     // Timer0 counts from reset until the first key
+static uint16_t uptimeRead; // Timer0 count when uptime was last updated
 
 #if !defined(KEYBOARD_OUTPUT_REPORT_DATA_BUFFER_ADDRESS_TAG)
     #define KEYBOARD_OUTPUT_REPORT_DATA_BUFFER_ADDRESS_TAG
@@ -479,6 +506,8 @@ static unsigned char columnBits6[12] = {
 static int tick;
 static int8_t xmit = XMIT_NORMAL;
 
+static APP_KEYBOARD_TIMING timing;
+
 
 // *****************************************************************************
 // *****************************************************************************
@@ -495,6 +524,10 @@ static int8_t xmit = XMIT_NORMAL;
 
 void APP_KeyboardConfigure(void)
 {
+    // Timer0 runs from reset on to time the start-up as well as the scans.
+    OpenTimer0(TIMER_INT_OFF & T0_16BIT & T0_SOURCE_INT & T0_PS_1_256);
+    uptimeRead = ReadTimer0();
+
 #if APP_MACHINE_VALUE != 0x4550
     if (6 <= BOARD_REV_VALUE) {
         for (char i = 0; i < 8; ++i) {
@@ -538,6 +571,13 @@ void APP_KeyboardInit(void)
     //initialize the variable holding the handle for the last
     // transmission
     keyboard.lastINTransmission = 0;
+    keyboard.nextSlot = 0;
+    keyboard.head = keyboard.count = 0;
+    memset(reportSlots, 0, sizeof reportSlots);
+    keyboard.waiting = false;
+    memset(&stats, 0, sizeof stats);
+    memset(&timing, 0, sizeof timing);
+    timing.min = 0xffff;
 
     //initialize the variable holding the keyboard LED state data.
     //Note OS X assumes every LED is turned off by default.
@@ -549,7 +589,6 @@ void APP_KeyboardInit(void)
     //Arm OUT endpoint so we can receive caps lock, num lock, etc. info from host
     keyboard.lastOUTTransmission = HIDRxPacket(HID_EP, (uint8_t*) &outputReport, sizeof(outputReport));
 
-    OpenTimer0(TIMER_INT_OFF & T0_16BIT & T0_SOURCE_INT & T0_PS_1_256);
     tick = (int) ReadTimer0();
 }
 
@@ -593,7 +632,7 @@ uint8_t* APP_KeyboardScan(void)
         xmit = makeReport((uint8_t*) &inputReport);
         switch (xmit) {
         case XMIT_BRK:
-            memset(&inputReport + 2, 0, 6);
+            memset(inputReport.keys, 0, 6);
             break;
         case XMIT_NORMAL:
             break;
@@ -618,25 +657,195 @@ uint8_t* APP_KeyboardScan(void)
     return (uint8_t*) &inputReport;
 }
 
+const APP_KEYBOARD_STATS* APP_KeyboardGetStats(void)
+{
+    return &stats;
+}
+
+const APP_KEYBOARD_TIMING* APP_KeyboardGetTiming(void)
+{
+    return &timing;
+}
+
+const APP_KEYBOARD_STARTUP* APP_KeyboardGetStartup(void)
+{
+    return &startup;
+}
+
+/* Returns the time from reset in msec, from 1 up to 65535 so that 0 can
+ * mark a step not reached yet. Timer0 wraps around in about 1.4 seconds, so
+ * this has to be called more often than that until the first key. */
+static uint16_t APP_KeyboardUptime(void)
+{
+    uint16_t now = ReadTimer0();
+    uint32_t msec;
+
+    uptime += (uint16_t) (now - uptimeRead);
+    uptimeRead = now;
+    msec = uptime / (APP_TIMER0_FREQ / 1000);
+    if (0xffff < msec)
+        return 0xffff;
+    return msec ? (uint16_t) msec : 1;
+}
+
+/* Keeps the start-up clock running from the main loop, and records when the
+ * device has been attached and configured. */
+void APP_KeyboardStartupTasks(void)
+{
+    uint16_t msec;
+
+    if (startup.firstKey)
+        return;
+    msec = APP_KeyboardUptime();
+    if (!startup.attach)
+        startup.attach = msec;
+    if (!startup.configured && CONFIGURED_STATE <= USBGetDeviceState())
+        startup.configured = msec;
+}
+
+/* Record the times once the last report has been taken by an IN token. */
+static void APP_KeyboardCheckSent(uint16_t now)
+{
+    uint16_t wait;
+    uint8_t i;
+
+    if (!keyboard.waiting || HIDTxHandleBusy(keyboard.lastINTransmission))
+        return;
+    keyboard.waiting = false;
+    if (!startup.firstKey) {
+        const KEYBOARD_INPUT_REPORT* sent = &reportSlots[keyboard.nextSlot ^ 1];
+        if (sent->modifiers.value || sent->keys[0])
+            startup.firstKey = APP_KeyboardUptime();
+    }
+    wait = now - keyboard.loaded;
+    if (wait < timing.min)
+        timing.min = wait;
+    if (timing.max < wait)
+        timing.max = wait;
+    timing.sum += wait;
+    ++timing.count;
+
+    wait = (uint16_t) (now - keyboard.scanned) / (APP_TIMER0_FREQ / 1000);
+    for (i = 0; wait && i < APP_LATENCY_BUCKETS - 1; ++i)
+        wait >>= 1;
+    ++timing.latency[i];
+}
+
+#ifdef USB_SOF_SYNC
+/* Wait until the scan due SCAN_FRAMES frames after the last one can just
+ * finish before the next SOF, measuring meanwhile how long the last report
+ * waited for its IN token. Falls back to SCAN_DELAY without SOFs. */
+static void APP_KeyboardWaitForFrame(void)
+{
+    uint8_t frame = UFRML;
+    uint8_t frames = 0;
+    uint16_t sof = 0;
+    uint16_t phase = 0;
+    uint16_t now;
+
+    if (timing.scan + SCAN_GUARD < FRAME_COUNTS)
+        phase = FRAME_COUNTS - SCAN_GUARD - timing.scan;
+    for (;;) {
+        now = ReadTimer0();
+        if (frame != UFRML) {
+            frame = UFRML;
+            sof = now;
+            ++frames;
+#ifdef ENABLE_MOUSE
+            APP_DeviceMouseTasks();
+#endif
+        }
+        APP_KeyboardCheckSent(now);
+        LED_Pulse((uint16_t) (now - tick), SCAN_DELAY);
+        if (SCAN_FRAMES - 1 <= frames && phase <= (uint16_t) (now - sof))
+            break;
+        if (SCAN_DELAY + FRAME_COUNTS <= (uint16_t) (now - tick))
+            break;
+    }
+    tick = (int) now;
+}
+#endif
+
+/* Queue a copy of report unless it is the same as the last one queued or
+ * sent; such a report carries no transition and is merged into it. */
+static void APP_KeyboardQueueReport(const KEYBOARD_INPUT_REPORT* report)
+{
+    const KEYBOARD_INPUT_REPORT* last;
+
+    if (keyboard.count)
+        last = &reportQueue[(keyboard.head + keyboard.count - 1) & (REPORT_QUEUE_SIZE - 1)];
+    else
+        last = &reportSlots[keyboard.nextSlot ^ 1];
+    if (!memcmp(report, last, sizeof(KEYBOARD_INPUT_REPORT))) {
+        ++stats.merges;
+        return;
+    }
+    reportQueue[(keyboard.head + keyboard.count) & (REPORT_QUEUE_SIZE - 1)] = *report;
+    reportStamps[(keyboard.head + keyboard.count) & (REPORT_QUEUE_SIZE - 1)] = tick;
+    ++keyboard.count;
+}
+
+/* Hand the queued reports over to the endpoint in order while either of its
+ * ping-pong buffers is free. The buffers are used in turn as reportSlots[]
+ * are, so reportSlots[nextSlot] belongs to the free buffer. */
+static void APP_KeyboardSendReports(void)
+{
+    while (keyboard.count && !USBHandleBusy(USBGetNextHandle(HID_EP, IN_TO_HOST))) {
+        reportSlots[keyboard.nextSlot] = reportQueue[keyboard.head];
+        keyboard.scanned = reportStamps[keyboard.head];
+        keyboard.head = (keyboard.head + 1) & (REPORT_QUEUE_SIZE - 1);
+        --keyboard.count;
+        keyboard.lastINTransmission = HIDTxPacket(HID_EP, (uint8_t*) &reportSlots[keyboard.nextSlot], sizeof(inputReport));
+        keyboard.nextSlot ^= 1;
+        keyboard.loaded = ReadTimer0();
+        keyboard.waiting = true;
+        ++stats.reports;
+        if (timing.scan < (uint16_t) (keyboard.loaded - tick))
+            timing.scan = keyboard.loaded - tick;
+    }
+}
+
 void APP_KeyboardTasks(void)
 {
     static int8_t cnt;
 
-    while (((int) ReadTimer0()) - tick < (int) SCAN_DELAY)
-        ;
+#ifdef USB_SOF_SYNC
+    APP_KeyboardWaitForFrame();
+#else
+    while (((int) ReadTimer0()) - tick < (int) SCAN_DELAY) {
+        APP_KeyboardCheckSent(ReadTimer0());
+        LED_Pulse((uint16_t) (ReadTimer0() - tick), SCAN_DELAY);
+#ifdef ENABLE_MOUSE
+        APP_DeviceMouseTasks();
+#endif
+    }
     tick = (int) ReadTimer0();
-    if (++cnt & 1)
-        return;
-
-    /* Check if the IN endpoint is busy, and if it isn't check if we want to send
-     * keystroke data to the host. */
-    if (!HIDTxHandleBusy(keyboard.lastINTransmission)) {
-        uint8_t* report = APP_KeyboardScan();
-        if (report) {
-            APP_DeviceConsumerTasks(report);
-            keyboard.lastINTransmission = HIDTxPacket(HID_EP, report, sizeof(inputReport));
+#endif
+    LED_Tick();     // Start the on-pulses of the dimmed LEDs for this scan.
+    if (!(++cnt & 1)) {
+        /* Scan the keys unless the queue is full; the keys are then left
+         * in the matrix and the engine until the next scan. */
+        if (keyboard.count < REPORT_QUEUE_SIZE) {
+            uint8_t* report = APP_KeyboardScan();
+            ++stats.scans;
+            if (report) {
+                APP_DeviceConsumerTasks(report);
+                APP_KeyboardQueueReport(&inputReport);
+            } else if (!keyboard.count) {
+                /* Repeat the last report at the idle rate set by the host,
+                 * if any. */
+                uint8_t idle = USBHIDGetIdleRate(HID_INTF_ID);
+                if (idle && (uint16_t) idle * IDLE_UNIT <= (uint16_t) (ReadTimer0() - keyboard.loaded)) {
+                    reportQueue[keyboard.head] = reportSlots[keyboard.nextSlot ^ 1];
+                    reportStamps[keyboard.head] = tick;
+                    keyboard.count = 1;
+                }
+            }
+        } else {
+            ++stats.stalls;
         }
     }
+    APP_KeyboardSendReports();
 
     /* Check if any data was sent from the PC to the keyboard device.  Report
      * descriptor allows host to send 1 byte of data.  Bits 0-4 are LED states,
@@ -663,6 +872,50 @@ void APP_WakeFromSuspend()
     SYSTEM_Initialize(SYSTEM_STATE_USB_RESUME);
 }
 
+/* Sleep while the bus is suspended until the host resumes it or, if the host
+ * has armed remote wakeup, until a key is pressed. Returns true for a key;
+ * the key is then scanned by the following APP_KeyboardTasks() calls and
+ * its report is sent once the host has resumed the bus. */
+bool APP_KeyboardSleep(bool remoteWakeup)
+{
+    SyncNvram();    // Save the profile selection while nothing is typed.
+#ifdef BUTTON_HAS_WAKE_UP
+    bool pressed = false;
+    uint8_t gie = INTCONbits.GIE;
+    uint8_t swdten = WDTCONbits.SWDTEN;
+
+    APP_LEDUpdate(0);
+
+    INTCONbits.GIE = 0;     // Wake up without vectoring; the USB interrupt is serviced later.
+    if (remoteWakeup) {
+        BUTTON_EnableWakeUp();
+        // The columns on PORTD are checked at each WDT wake-up.
+        WDTCONbits.REGSLP = 1;
+        WDTCONbits.SWDTEN = 1;
+    }
+    while (USBIsDeviceSuspended() && !USBActivityIF) {
+        if (remoteWakeup && BUTTON_IsDown()) {
+            pressed = true;
+            break;
+        }
+        Sleep();
+        Nop();
+        BUTTON_ClearWakeUpFlags();
+    }
+    if (remoteWakeup) {
+        WDTCONbits.SWDTEN = swdten;
+        BUTTON_DisableWakeUp();
+    }
+    INTCONbits.GIE = gie;
+
+    APP_KeyboardProcessOutputReport();
+    return pressed;
+#else
+    // No key can wake up the MCU; poll them at the suspended clock.
+    return remoteWakeup && BUTTON_IsPressed();
+#endif
+}
+
 static void USBHIDCBSetReportComplete(void)
 {
     /* 1 byte of LED state data should now be in the CtrlTrfData buffer.  Copy
@@ -672,12 +925,38 @@ static void USBHIDCBSetReportComplete(void)
 
 void USBHIDCBSetReportHandler(void)
 {
+#ifdef ENABLE_MOUSE
+    if (SetupPkt.bIntfID == HID_MOUSE_INTF_ID) {
+        APP_DeviceMouseSetReportHandler();
+        return;
+    }
+#endif
+    if (SetupPkt.bIntfID == HID_TELEMETRY_INTF_ID) {
+        APP_DeviceConfigSetReportHandler();
+        return;
+    }
     /* Prepare to receive the keyboard LED state data through a SET_REPORT
      * control transfer on endpoint 0.  The host should only send 1 byte,
      * since this is all that the report descriptor allows it to send. */
     USBEP0Receive((uint8_t*)&CtrlTrfData, USB_EP0_BUFF_SIZE, USBHIDCBSetReportComplete);
 }
 
+void USBHIDCBGetReportHandler(void)
+{
+    /* Only the mouse and the telemetry interface have FEATURE reports; leave
+     * the other requests unclaimed so that they are stalled. */
+#ifdef ENABLE_MOUSE
+    if (SetupPkt.bIntfID == HID_MOUSE_INTF_ID)
+        APP_DeviceMouseGetReportHandler();
+#endif
+    if (SetupPkt.bIntfID == HID_TELEMETRY_INTF_ID) {
+        if (SetupPkt.W_Value.byte.LB == CONFIG_REPORT_SETTINGS)
+            APP_DeviceConfigGetReportHandler();
+        else
+            APP_DeviceTelemetryGetReportHandler();
+    }
+}
+
 /*******************************************************************************
  End of File
 */
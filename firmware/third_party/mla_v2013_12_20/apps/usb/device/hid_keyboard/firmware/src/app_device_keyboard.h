@@ -31,6 +31,7 @@
 #ifndef APP_KEYBOARD_H
 #define APP_KEYBOARD_H
 
+#include <stdbool.h>
 #include <stdint.h>
 
 void APP_KeyboardConfigure(void);
@@ -39,7 +40,45 @@ uint8_t* APP_KeyboardScan(void);
 void APP_KeyboardTasks(void);
 void APP_Suspend();
 void APP_WakeFromSuspend();
+bool APP_KeyboardSleep(bool remoteWakeup);
 
 void APP_KeyboardProcessOutputReport(void);
 
+#define APP_TIMER0_FREQ     (_XTAL_FREQ / 4 / 256)
+#define APP_LATENCY_BUCKETS 8
+
+typedef struct
+{
+    uint32_t scans;
+    uint32_t reports;   // reports handed over to the endpoint
+    uint16_t merges;    // reports merged into the same previous report
+    uint16_t stalls;    // scans put off while the report queue was full
+} APP_KEYBOARD_STATS;
+
+typedef struct
+{
+    uint16_t scan;      // longest scan [Timer0 counts]
+    uint16_t min;       // shortest time from loading a report to its IN token
+    uint16_t max;       // longest time from loading a report to its IN token
+    uint32_t sum;
+    uint16_t count;
+    // Reports by the time from the scan to the IN token: less than 1 msec,
+    // less than 2, 4, 8, ... msec, and the rest.
+    uint16_t latency[APP_LATENCY_BUCKETS];
+} APP_KEYBOARD_TIMING;
+
+// Time from reset to each step of the start-up [msec]; 0 until the step is
+// reached, and 65535 at most.
+typedef struct
+{
+    uint16_t attach;        // USBDeviceAttach()
+    uint16_t configured;    // SET_CONFIGURATION from the host
+    uint16_t firstKey;      // the first key press taken by an IN token
+} APP_KEYBOARD_STARTUP;
+
+const APP_KEYBOARD_STATS* APP_KeyboardGetStats(void);
+const APP_KEYBOARD_TIMING* APP_KeyboardGetTiming(void);
+const APP_KEYBOARD_STARTUP* APP_KeyboardGetStartup(void);
+void APP_KeyboardStartupTasks(void);
+
 #endif
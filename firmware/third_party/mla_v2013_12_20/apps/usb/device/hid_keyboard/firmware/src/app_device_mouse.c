@@ -34,12 +34,14 @@
 #include <system.h>
 
 #include <stdint.h>
+#include <plib/timers.h>
 
 #include <usb/usb.h>
 #include <usb/usb_device.h>
 #include <usb/usb_device_hid.h>
 
 #include <app_led_usb_status.h>
+#include <app_device_keyboard.h>
 #include <app_device_mouse.h>
 #include <usb_config.h>
 
@@ -74,12 +76,31 @@ const struct{uint8_t report[HID_RPT03_SIZE];}hid_rpt03=
         0x05, 0x01, /*      Usage Page (Generic Desktop)        */
         0x09, 0x30, /*      Usage (X)                           */
         0x09, 0x31, /*      Usage (Y)                           */
-        0x09, 0x38, /*      Usage (Wheel)                       */
         0x15, 0x81, /*      Logical Minimum (-127)              */
         0x25, 0x7F, /*      Logical Maximum (127)               */
         0x75, 0x08, /*      Report Size (8)                     */
-        0x95, 0x03, /*      Report Count (3)                    */
+        0x95, 0x02, /*      Report Count (2)                    */
         0x81, 0x06, /*      Input (Data, Variable, Relative)    */
+        0xA1, 0x02, /*      Collection (Logical)                */
+        0x09, 0x48, /*          Usage (Resolution Multiplier)   */
+        0x15, 0x00, /*          Logical Minimum (0)             */
+        0x25, 0x01, /*          Logical Maximum (1)             */
+        0x35, 0x01, /*          Physical Minimum (1)            */
+        0x45, WHEEL_MULTIPLIER, /*  Physical Maximum (8)        */
+        0x75, 0x02, /*          Report Size (2)                 */
+        0x95, 0x01, /*          Report Count (1)                */
+        0xB1, 0x02, /*          Feature (Data, Variable, Absolute) */
+        0x35, 0x00, /*          Physical Minimum (0)            */
+        0x45, 0x00, /*          Physical Maximum (0)            */
+        0x75, 0x06, /*          Report Size (6)                 */
+        0xB1, 0x01, /*          Feature (Constant)  ;6 bit padding */
+        0x09, 0x38, /*          Usage (Wheel)                   */
+        0x15, 0x81, /*          Logical Minimum (-127)          */
+        0x25, 0x7F, /*          Logical Maximum (127)           */
+        0x75, 0x08, /*          Report Size (8)                 */
+        0x95, 0x01, /*          Report Count (1)                */
+        0x81, 0x06, /*          Input (Data, Variable, Relative) */
+        0xC0,       /*      End Collection                      */
         0xC0, 0xC0  /* End Collection,End Collection            */
     }
 };
@@ -187,10 +208,48 @@ typedef struct __attribute__((packed))
 typedef struct
 {
     USB_HANDLE lastINTransmission;
+    uint16_t stamp;         // Timer0 count up to which the wheel has scrolled
+    int16_t x;              // motion not reported yet
+    int16_t y;
+    int16_t wheel;
 } MOUSE;
 
 static MOUSE mouse;
 
+/* FEATURE report - the resolution multiplier of the wheel in bits 0-1; the
+ * wheel is reported in 1/WHEEL_MULTIPLIER notches while it is 1.
+ */
+static uint8_t featureReport;
+
+/* Timer0 counts per msec, and the limit of the motion kept while the host
+ * does not take the reports.
+ */
+#define MOUSE_MSEC_COUNTS   (APP_TIMER0_FREQ / 1000)
+#define MOUSE_PENDING_MAX   1024
+
+static void addMotion(int16_t* sum, int8_t delta)
+{
+    *sum += delta;
+    if (*sum < -MOUSE_PENDING_MAX)
+        *sum = -MOUSE_PENDING_MAX;
+    else if (MOUSE_PENDING_MAX < *sum)
+        *sum = MOUSE_PENDING_MAX;
+}
+
+static int8_t takeMotion(int16_t* sum)
+{
+    int8_t delta;
+
+    if (*sum < -127)
+        delta = -127;
+    else if (127 < *sum)
+        delta = 127;
+    else
+        delta = *sum;
+    *sum -= delta;
+    return delta;
+}
+
 /*********************************************************************
 * Function: void APP_DeviceMouseInitialize(void);
 *
@@ -225,6 +284,13 @@ void APP_DeviceMouseInitialize(void)
 
     /* initialize the handles to invalid so we know they aren't being used. */
     mouse.lastINTransmission = NULL;
+    mouse.stamp = ReadTimer0();
+    mouse.x = mouse.y = mouse.wheel = 0;
+
+    /* The host sets the resolution multiplier again after it configures the
+     * device. */
+    featureReport = 0;
+    setMouseWheelResolution(1);
 
     //enable the HID endpoint
     USBEnableEndpoint(HID_MOUSE_EP,USB_IN_ENABLED|USB_HANDSHAKE_ENABLED|USB_DISALLOW_SETUP);
@@ -246,26 +312,61 @@ void APP_DeviceMouseInitialize(void)
 ********************************************************************/
 void APP_DeviceMouseTasks(void)
 {
+    uint16_t msec;
+    uint8_t buttons;
+
+    /* Scroll the wheel for the time passed, and process the touch frames
+     * queued by the UART interrupt. The motion is added up until the host
+     * takes it so that none is lost while the endpoint is busy.
+     */
+    msec = (uint16_t) (ReadTimer0() - mouse.stamp) / MOUSE_MSEC_COUNTS;
+    if (msec) {
+        mouse.stamp += (uint16_t) msec * MOUSE_MSEC_COUNTS;
+        processMouseWheel((msec < 255) ? msec : 255);
+    }
+    if (processMouseSamples()) {
+        addMotion(&mouse.x, getKeyboardMouseX());
+        addMotion(&mouse.y, getKeyboardMouseY());
+        addMotion(&mouse.wheel, getKeyboardMouseWheel());
+    }
+
     /* Do not report unchanged state.
      */
-    if (mouseReport.buttons.value == getKeyboardMouseButtons() &&
-        mouseReport.x == 0 && mouseReport.x == getKeyboardMouseX() &&
-        mouseReport.y == 0 && mouseReport.y == getKeyboardMouseY() &&
-        mouseReport.wheel == 0 && mouseReport.wheel == getKeyboardMouseWheel())
-    {
+    buttons = getKeyboardMouseButtons();
+    if (mouseReport.buttons.value == buttons && !mouse.x && !mouse.y && !mouse.wheel)
         return;
-    }
 
     /* We can only send a report if the last report has been sent.
      */
     if(HIDTxHandleBusy(mouse.lastINTransmission) == false)
     {
-        mouseReport.buttons.value = getKeyboardMouseButtons();
-        mouseReport.x = getKeyboardMouseX();
-        mouseReport.y = getKeyboardMouseY();
-        mouseReport.wheel = getKeyboardMouseWheel();
-        mouse.lastINTransmission = HIDTxPacket(HID_MOUSE_EP, (uint8_t*) &mouseReport, sizeof mouseReport);
+        mouseReport.buttons.value = buttons;
+        mouseReport.x = takeMotion(&mouse.x);
+        mouseReport.y = takeMotion(&mouse.y);
+        mouseReport.wheel = takeMotion(&mouse.wheel);
+        /* The boot protocol report ends before the wheel. */
+        mouse.lastINTransmission = HIDTxPacket(HID_MOUSE_EP, (uint8_t*) &mouseReport,
+            (USBHIDGetProtocol(HID_MOUSE_INTF_ID) == HID_BOOT_PROTOCOL) ? 3 : sizeof mouseReport);
     }
 }//end ProcessIO
 
+static void APP_DeviceMouseSetReportComplete(void)
+{
+    featureReport = CtrlTrfData[0] & 0x03;
+    setMouseWheelResolution(featureReport ? WHEEL_MULTIPLIER : 1);
+}
+
+void APP_DeviceMouseSetReportHandler(void)
+{
+    /* Only the FEATURE report can be set. */
+    if (SetupPkt.W_Value.byte.HB == 0x03)
+        USBEP0Receive((uint8_t*)&CtrlTrfData, USB_EP0_BUFF_SIZE, APP_DeviceMouseSetReportComplete);
+}
+
+void APP_DeviceMouseGetReportHandler(void)
+{
+    if (SetupPkt.W_Value.byte.HB == 0x03)
+        USBEP0SendRAMPtr(&featureReport, sizeof featureReport, USB_EP0_INCLUDE_ZERO);
+}
+
 #endif
@@ -53,7 +53,8 @@ void APP_DeviceMouseInitialize();
 /*********************************************************************
 * Function: void APP_DeviceMouseTasks(void);
 *
-* Overview: Keeps the demo running.
+* Overview: Reports the touch pad motion. Called every frame while the
+*   keyboard waits for its next scan, independently of the key reports.
 *
 * PreCondition: The demo should have been initialized and started via
 *   the APP_DeviceMouseInitialize() and APP_DeviceMouseStart() demos
@@ -66,4 +67,22 @@ void APP_DeviceMouseInitialize();
 ********************************************************************/
 void APP_DeviceMouseTasks();
 
+/*********************************************************************
+* Function: void APP_DeviceMouseSetReportHandler(void);
+*           void APP_DeviceMouseGetReportHandler(void);
+*
+* Overview: Handles SET_REPORT and GET_REPORT requests to the mouse
+*   interface for the FEATURE report that holds the resolution multiplier
+*   of the wheel.
+*
+* PreCondition: SetupPkt.bIntfID is HID_MOUSE_INTF_ID.
+*
+* Input: None
+*
+* Output: None
+*
+********************************************************************/
+void APP_DeviceMouseSetReportHandler(void);
+void APP_DeviceMouseGetReportHandler(void);
+
 #endif
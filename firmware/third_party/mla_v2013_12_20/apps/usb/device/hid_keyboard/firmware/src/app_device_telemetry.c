@@ -0,0 +1,224 @@
+/*
+ * Copyright 2026 Esrille Inc.
+ *
+ * This file is a modified version of app_device_mouse.c provided by
+ * Microchip Technology, Inc. for using Esrille New Keyboard.
+ * See the file NOTICE for copying permission.
+ */
+
+/********************************************************************
+ Software License Agreement:
+
+ The software supplied herewith by Microchip Technology Incorporated
+ (the "Company") for its PIC(R) Microcontroller is intended and
+ supplied to you, the Company's customer, for use solely and
+ exclusively on Microchip PIC Microcontroller products. The
+ software is owned by the Company and/or its supplier, and is
+ protected under applicable copyright laws. All rights are reserved.
+ Any use in violation of the foregoing restrictions may subject the
+ user to criminal sanctions under applicable laws, as well as to
+ civil liability for the breach of the terms and conditions of this
+ license.
+
+ THIS SOFTWARE IS PROVIDED IN AN "AS IS" CONDITION. NO WARRANTIES,
+ WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+ TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. THE COMPANY SHALL NOT,
+ IN ANY CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL OR
+ CONSEQUENTIAL DAMAGES, FOR ANY REASON WHATSOEVER.
+********************************************************************/
+
+/** INCLUDES *******************************************************/
+#include <system.h>
+
+#include <stdint.h>
+
+#include <usb/usb.h>
+#include <usb/usb_device.h>
+#include <usb/usb_device_hid.h>
+
+#include <app_device_config.h>
+#include <app_device_keyboard.h>
+#include <app_device_telemetry.h>
+#include <usb_config.h>
+
+#include "Keyboard.h"
+#ifdef WITH_HOS
+#include "HosMaster.h"
+#endif
+
+/*******************************************************************************
+ * HID Report Descriptor - vendor defined FEATURE reports: two read-only
+ * telemetry reports and the settings report of app_device_config.c.
+ * Nothing is sent over the interrupt IN endpoint; the host polls the
+ * reports through GET_REPORT so that reading them never competes with the
+ * key reports.
+ ******************************************************************************/
+const struct{uint8_t report[HID_RPT04_SIZE];}hid_rpt04=
+{
+    {
+        0x06, 0x00, 0xFF,   /* Usage Page (Vendor Defined 0xFF00)   */
+        0x09, 0x01,         /* Usage (1)                            */
+        0xA1, 0x01,         /* Collection (Application)             */
+        0x15, 0x00,         /*   Logical Minimum (0)                */
+        0x26, 0xFF, 0x00,   /*   Logical Maximum (255)              */
+        0x75, 0x08,         /*   Report Size (8)                    */
+        0x85, TELEMETRY_REPORT_COUNTERS,    /* Report ID (1)        */
+        0x09, 0x02,         /*   Usage (2)                          */
+        0x95, 0x1B,         /*   Report Count (27)                  */
+        0xB1, 0x02,         /*   Feature (Data,Var,Abs)             */
+        0x85, TELEMETRY_REPORT_LATENCY,     /* Report ID (2)        */
+        0x09, 0x03,         /*   Usage (3)                          */
+        0x95, 0x18,         /*   Report Count (24)                  */
+        0xB1, 0x02,         /*   Feature (Data,Var,Abs)             */
+        0x85, CONFIG_REPORT_SETTINGS,       /* Report ID (3)        */
+        0x09, 0x04,         /*   Usage (4)                          */
+        0x95, CONFIG_REPORT_SIZE,           /* Report Count (41)    */
+        0xB1, 0x02,         /*   Feature (Data,Var,Abs)             */
+        0xC0                /* End Collection                       */
+    }
+};
+
+/*******************************************************************************
+ * Report Data Types - multi-byte fields are little endian.
+ ******************************************************************************/
+typedef struct __attribute__((packed))
+{
+    uint8_t id;             // TELEMETRY_REPORT_COUNTERS
+    uint8_t version;        // TELEMETRY_VERSION
+    uint32_t scans;
+    uint32_t reports;
+    uint16_t ghosts;
+    uint16_t bounces;
+    uint8_t macroDepth;
+    uint8_t macroMax;
+    uint16_t hosRetries;
+    uint16_t merges;
+    uint16_t stalls;
+    uint16_t attach;        // from reset to each step of the start-up [msec]
+    uint16_t configured;
+    uint16_t firstKey;
+} TELEMETRY_COUNTERS;
+
+typedef struct __attribute__((packed))
+{
+    uint8_t id;             // TELEMETRY_REPORT_LATENCY
+    uint16_t scan;          // longest scan [usec]
+    uint16_t min;           // from loading a report to its IN token [usec]
+    uint16_t avg;
+    uint16_t max;
+    uint16_t latency[APP_LATENCY_BUCKETS];
+} TELEMETRY_LATENCY;
+
+static union
+{
+    TELEMETRY_COUNTERS counters;
+    TELEMETRY_LATENCY latency;
+} featureReport;
+
+static uint16_t toMicroseconds(uint32_t counts)
+{
+    // Saturate before counts * 1000000 overflows, at about 91 ms.
+    if (0xffffUL * APP_TIMER0_FREQ / 1000000 < counts)
+        return 0xffff;
+    return (uint16_t) (counts * 1000000 / APP_TIMER0_FREQ);
+}
+
+/* These run in the USB interrupt while the main loop keeps counting; a
+ * multi-byte counter can be off by a carry now and then, which does no harm
+ * to sampled statistics. */
+static void takeCounters(void)
+{
+    const APP_KEYBOARD_STATS* app = APP_KeyboardGetStats();
+    const KeyboardStats* stats = getKeyboardStats();
+    const APP_KEYBOARD_STARTUP* startup = APP_KeyboardGetStartup();
+
+    featureReport.counters.id = TELEMETRY_REPORT_COUNTERS;
+    featureReport.counters.version = TELEMETRY_VERSION;
+    featureReport.counters.scans = app->scans;
+    featureReport.counters.reports = app->reports;
+    featureReport.counters.ghosts = stats->ghosts;
+    featureReport.counters.bounces = stats->bounces;
+    featureReport.counters.macroDepth = getMacroDepth();
+    featureReport.counters.macroMax = stats->macroMax;
+#ifdef WITH_HOS
+    featureReport.counters.hosRetries = HosGetStats()->retries;
+#else
+    featureReport.counters.hosRetries = 0;
+#endif
+    featureReport.counters.merges = app->merges;
+    featureReport.counters.stalls = app->stalls;
+    featureReport.counters.attach = startup->attach;
+    featureReport.counters.configured = startup->configured;
+    featureReport.counters.firstKey = startup->firstKey;
+}
+
+static void takeLatency(void)
+{
+    const APP_KEYBOARD_TIMING* timing = APP_KeyboardGetTiming();
+    uint8_t i;
+
+    featureReport.latency.id = TELEMETRY_REPORT_LATENCY;
+    featureReport.latency.scan = toMicroseconds(timing->scan);
+    if (timing->count) {
+        featureReport.latency.min = toMicroseconds(timing->min);
+        featureReport.latency.avg = toMicroseconds(timing->sum / timing->count);
+        featureReport.latency.max = toMicroseconds(timing->max);
+    } else {
+        featureReport.latency.min = 0;
+        featureReport.latency.avg = 0;
+        featureReport.latency.max = 0;
+    }
+    for (i = 0; i < APP_LATENCY_BUCKETS; ++i)
+        featureReport.latency.latency[i] = timing->latency[i];
+}
+
+/*********************************************************************
+* Function: void APP_DeviceTelemetryInitialize(void);
+*
+* Overview: Enables the telemetry interface endpoint.
+*
+* PreCondition: None
+*
+* Input: None
+*
+* Output: None
+*
+********************************************************************/
+void APP_DeviceTelemetryInitialize(void)
+{
+    //enable the HID endpoint
+    USBEnableEndpoint(HID_TELEMETRY_EP,USB_IN_ENABLED|USB_HANDSHAKE_ENABLED|USB_DISALLOW_SETUP);
+}
+
+/*********************************************************************
+* Function: void APP_DeviceTelemetryGetReportHandler(void);
+*
+* Overview: Answers GET_REPORT(FEATURE) requests with a snapshot of the
+*   keyboard statistics.  Other requests are left unclaimed so that they
+*   are stalled.
+*
+* PreCondition: The request is for HID_TELEMETRY_INTF_ID.
+*
+* Input: None
+*
+* Output: None
+*
+********************************************************************/
+void APP_DeviceTelemetryGetReportHandler(void)
+{
+    if (SetupPkt.W_Value.byte.HB != 0x03)
+        return;
+    switch (SetupPkt.W_Value.byte.LB) {
+    case TELEMETRY_REPORT_COUNTERS:
+        takeCounters();
+        USBEP0SendRAMPtr((uint8_t*) &featureReport, sizeof(TELEMETRY_COUNTERS), USB_EP0_INCLUDE_ZERO);
+        break;
+    case TELEMETRY_REPORT_LATENCY:
+        takeLatency();
+        USBEP0SendRAMPtr((uint8_t*) &featureReport, sizeof(TELEMETRY_LATENCY), USB_EP0_INCLUDE_ZERO);
+        break;
+    default:
+        break;
+    }
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2026 Esrille Inc.
+ *
+ * This file is a modified version of app_device_mouse.h provided by
+ * Microchip Technology, Inc. for using Esrille New Keyboard.
+ * See the file NOTICE for copying permission.
+ */
+
+/********************************************************************
+ Software License Agreement:
+
+ The software supplied herewith by Microchip Technology Incorporated
+ (the "Company") for its PIC(R) Microcontroller is intended and
+ supplied to you, the Company's customer, for use solely and
+ exclusively on Microchip PIC Microcontroller products. The
+ software is owned by the Company and/or its supplier, and is
+ protected under applicable copyright laws. All rights are reserved.
+ Any use in violation of the foregoing restrictions may subject the
+ user to criminal sanctions under applicable laws, as well as to
+ civil liability for the breach of the terms and conditions of this
+ license.
+
+ THIS SOFTWARE IS PROVIDED IN AN "AS IS" CONDITION. NO WARRANTIES,
+ WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+ TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. THE COMPANY SHALL NOT,
+ IN ANY CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL OR
+ CONSEQUENTIAL DAMAGES, FOR ANY REASON WHATSOEVER.
+ *******************************************************************/
+
+#ifndef APP_DEVICE_TELEMETRY_H
+#define APP_DEVICE_TELEMETRY_H
+
+#include <usb/usb_device.h>
+#include <usb/usb_device_hid.h>
+
+// Telemetry FEATURE reports on the vendor defined interface
+#define TELEMETRY_VERSION           2
+#define TELEMETRY_REPORT_COUNTERS   1
+#define TELEMETRY_REPORT_LATENCY    2
+
+/*********************************************************************
+* Function: void APP_DeviceTelemetryInitialize(void);
+*
+* Overview: Enables the telemetry interface endpoint.
+*
+* PreCondition: None
+*
+* Input: None
+*
+* Output: None
+*
+********************************************************************/
+void APP_DeviceTelemetryInitialize(void);
+
+/*********************************************************************
+* Function: void APP_DeviceTelemetryGetReportHandler(void);
+*
+* Overview: Answers GET_REPORT(FEATURE) requests with a snapshot of the
+*   keyboard statistics.
+*
+* PreCondition: The request is for HID_TELEMETRY_INTF_ID.
+*
+* Input: None
+*
+* Output: None
+*
+********************************************************************/
+void APP_DeviceTelemetryGetReportHandler(void);
+
+#endif
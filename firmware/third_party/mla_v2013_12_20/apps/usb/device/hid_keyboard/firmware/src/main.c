@@ -70,6 +70,8 @@ SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
 #include "app_device_keyboard.h"
 #include "app_device_cc.h"
 #include "app_device_mouse.h"
+#include "app_device_telemetry.h"
+#include "app_device_config.h"
 
 #include <Keyboard.h>
 
@@ -105,33 +107,37 @@ int main(void)
     APP_KeyboardConfigure();
 
 #ifdef WITH_HOS
-    HosCheckDFU(BOOT_FLAGS_VALUE & BOOT_WITH_APP);
+    // In the BLE mode, HosMainLoop() checks the module by itself while
+    // scanning the keys so that typing can start immediately. In the USB
+    // mode, HosStartupTasks() does the same from the main loop below so that
+    // the host can enumerate the keyboard meanwhile.
+    if (BOOT_FLAGS_VALUE & BOOT_WITH_APP) {
+        HosCheckDFU(true);
+    }
     if (!isUSBMode() || !isBusPowered()) {
         HosMainLoop();
     }
-    for (uint16_t i = 0; i < HOS_STARTUP_DELAY; ++i) {
-        if (HosSleep(HOS_TYPE_DEFAULT)) {
-            break;
-        }
-        __delay_ms(4);
-    }
 #endif
 
     USBDeviceInit();
     USBDeviceAttach();
+    APP_KeyboardStartupTasks();
 
     for (;;)
     {
 #ifdef WITH_HOS
         if (!isBusPowered() || !isUSBMode()) {
+            SyncNvram();
             Reset();
             Nop();
             Nop();
             // NOT REACHED HERE
         }
+        HosStartupTasks();
 #endif
 
         SYSTEM_Tasks();
+        APP_KeyboardStartupTasks();
 
 #if defined(USB_POLLING)
         /* Check bus status and service USB interrupts.  Interrupt or polling
@@ -159,31 +165,27 @@ int main(void)
             continue;
         }
 
-        /* If we are currently suspended, then we need to see if we need to
-         * issue a remote wakeup.  In either case, we shouldn't process any
-         * keyboard commands since we aren't currently communicating to the host
-         * thus just continue back to the start of the while loop. */
+        /* If we are currently suspended, sleep until the host resumes the
+         * bus or a key is pressed, and then issue a remote wakeup for the key.
+         * Remote wakeup signalling does nothing unless the host has armed it. */
+        /* USBCBSendResume() takes the USB module out of suspend, so the keys
+         * are scanned on while the host answers the remote wakeup; the
+         * reports of the waking key are queued rather than lost. */
         if (USBIsDeviceSuspended())
         {
-            //Check if we should assert a remote wakeup request to the USB host,
-            //when the user presses the pushbutton.
-            if (BUTTON_IsPressed())
+            if (APP_KeyboardSleep(USBGetRemoteWakeupStatus()))
             {
-                USBCBSendResume();  //Does nothing unless we are in USB suspend with remote wakeup armed.
+                USBCBSendResume();
             }
 
             /* Jump back to the top of the while loop. */
             continue;
         }
 
-        if (USBIsBusSuspended())
-        {
-            /* Jump back to the top of the while loop. */
-            continue;
-        }
-
         /* Run the keyboard tasks. */
+        /* The mouse is reported while the keyboard waits for the next scan. */
         APP_KeyboardTasks();
+        APP_DeviceConfigTasks();
     }//end while
 }//end main
 
@@ -337,11 +339,13 @@ bool USER_USB_CALLBACK_EVENT_HANDLER(USB_EVENT event, void *pdata, uint16_t size
         case EVENT_CONFIGURED:
             /* When the device is configured, we can (re)initialize the keyboard
              * demo code. */
+            USBHIDInitialize();
             APP_KeyboardInit();
             APP_DeviceConsumerInitialize();
 #ifdef ENABLE_MOUSE
             APP_DeviceMouseInitialize();
 #endif
+            APP_DeviceTelemetryInitialize();
             break;
 
         case EVENT_SET_DESCRIPTOR:
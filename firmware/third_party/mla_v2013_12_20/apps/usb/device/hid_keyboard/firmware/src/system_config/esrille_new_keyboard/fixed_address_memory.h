@@ -33,11 +33,11 @@
 
 #define FIXED_ADDRESS_MEMORY
 
-#define KEYBOARD_INPUT_REPORT_DATA_BUFFER_ADDRESS_TAG   @0x500
-#define KEYBOARD_OUTPUT_REPORT_DATA_BUFFER_ADDRESS_TAG  @0x508
+#define KEYBOARD_INPUT_REPORT_DATA_BUFFER_ADDRESS_TAG   @0x500  // 2 slots
+#define KEYBOARD_OUTPUT_REPORT_DATA_BUFFER_ADDRESS_TAG  @0x510
 
-#define MOUSE_REPORT_DATA_BUFFER_ADDRESS                0x510
-#define CC_REPORT_DATA_BUFFER_ADDRESS                   0x518
+#define MOUSE_REPORT_DATA_BUFFER_ADDRESS                0x518
+#define CC_REPORT_DATA_BUFFER_ADDRESS                   0x520
 
 #define APP_VERSION_ADDRESS     0x1826  // The application image firmware version number address
 #define APP_VERSION_VALUE       0x0032  // BCD
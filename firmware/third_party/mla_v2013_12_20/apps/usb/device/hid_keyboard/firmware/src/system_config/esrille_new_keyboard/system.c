@@ -215,8 +215,8 @@ void interrupt SYS_InterruptHigh(void)
              * we are actually initialized and open before we do anything else,
              * otherwise we should exit the function without doing anything.
              */
-            if (USBGetDeviceState() == CONFIGURED_STATE && processSerialUnit(data)) {
-                APP_DeviceMouseTasks();
+            if (USBGetDeviceState() == CONFIGURED_STATE) {
+                processSerialUnit(data);    // The main loop processes the frame.
             }
         }
     }
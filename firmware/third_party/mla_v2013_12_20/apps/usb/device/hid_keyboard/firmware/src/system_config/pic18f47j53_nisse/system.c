@@ -125,6 +125,9 @@ SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
 const unsigned int VersionWord @ APP_VERSION_ADDRESS = APP_VERSION_VALUE;
 const unsigned int MachineWord @ APP_MACHINE_ADDRESS = APP_MACHINE_VALUE;
 
+static uint8_t pmd[4];      // PMDIS0 to PMDIS3 saved while suspended
+static bool shed;           // true while pmd[] is in effect
+
 
 // *****************************************************************************
 // *****************************************************************************
@@ -251,6 +254,19 @@ void SYSTEM_Initialize( SYSTEM_STATE state )
             break;
 
         case SYSTEM_STATE_USB_SUSPEND:
+            // Turn off the modules not used while suspended as HosMainLoop()
+            // does. The USARTs and MSSP2 are kept as they would be reset.
+            if (!shed) {
+                pmd[0] = PMDIS0;
+                pmd[1] = PMDIS1;
+                pmd[2] = PMDIS2;
+                pmd[3] = PMDIS3;
+                PMDIS0 |= 0xe3;
+                PMDIS1 |= 0xfe;
+                PMDIS2 |= 0x5f;
+                PMDIS3 |= 0xfe;
+                shed = true;
+            }
             OSCCON = 0x13;      // Sleep on sleep, 125kHz selected as microcontroller clock source
             break;
 
@@ -262,6 +278,14 @@ void SYSTEM_Initialize( SYSTEM_STATE state )
             //code.  If the PLL isn't being used, (ex: primary osc = 48MHz externally applied EC)
             //then this code adds a small unnecessary delay, but it is harmless to execute anyway.
             __delay_ms(2);
+
+            if (shed) {
+                PMDIS0 = pmd[0];
+                PMDIS1 = pmd[1];
+                PMDIS2 = pmd[2];
+                PMDIS3 = pmd[3];
+                shed = false;
+            }
             break;
     }
 }
@@ -287,8 +311,8 @@ void interrupt SYS_InterruptHigh(void)
              * we are actually initialized and open before we do anything else,
              * otherwise we should exit the function without doing anything.
              */
-            if (USBGetDeviceState() == CONFIGURED_STATE && processSerialUnit(data)) {
-                APP_DeviceMouseTasks();
+            if (USBGetDeviceState() == CONFIGURED_STATE) {
+                processSerialUnit(data);    // The main loop processes the frame.
             }
         }
     }
@@ -46,12 +46,11 @@
                                     // application related data.
 
 #ifndef ENABLE_MOUSE
-#define USB_MAX_NUM_INT         2
-#define USB_MAX_EP_NUMBER       2
+#define USB_MAX_NUM_INT         3
 #else
-#define USB_MAX_NUM_INT         3   //Set this number to match the maximum interface number used in the descriptors for this firmware project
-#define USB_MAX_EP_NUMBER       3   //Set this number to match the maximum endpoint number used in the descriptors for this firmware project
+#define USB_MAX_NUM_INT         4   //Set this number to match the maximum interface number used in the descriptors for this firmware project
 #endif
+#define USB_MAX_EP_NUMBER       4   //Set this number to match the maximum endpoint number used in the descriptors for this firmware project
 
 //Make sure only one of the below "#define USB_PING_PONG_MODE"
 //is uncommented.
@@ -64,6 +63,24 @@
 //#define USB_POLLING
 #define USB_INTERRUPT
 
+/* HID polling profile: the keyboard and consumer control IN endpoints are
+ * polled every frame unless USB_CONSERVATIVE_POLLING is defined, in which
+ * case they are polled every 10 frames. The mouse has its own interval. */
+//#define USB_CONSERVATIVE_POLLING
+#ifdef USB_CONSERVATIVE_POLLING
+#define HID_IN_INTERVAL     10
+#else
+#define HID_IN_INTERVAL     1
+
+/* Phase the key scan to the SOF so that each report is loaded just before
+ * the IN token of the next frame. */
+#define USB_SOF_SYNC
+#endif
+
+#ifndef HID_MOUSE_IN_INTERVAL
+#define HID_MOUSE_IN_INTERVAL   1
+#endif
+
 /* Parameter definitions are defined in usb_device.h */
 #define USB_PULLUP_OPTION USB_PULLUP_ENABLE
 //#define USB_PULLUP_OPTION USB_PULLUP_DISABLED
@@ -138,7 +155,7 @@
 #define HID_INT_OUT_EP_SIZE         1
 #define HID_INT_IN_EP_SIZE          8
 #define HID_RPT01_SIZE              64
-//#define USER_GET_REPORT_HANDLER USBHIDCBGetReportHandler
+#define USER_GET_REPORT_HANDLER USBHIDCBGetReportHandler
 #define USER_SET_REPORT_HANDLER USBHIDCBSetReportHandler
 
 /* HID - Consumer Control */
@@ -152,16 +169,22 @@
 #define HID_MOUSE_INTF_ID           0x02
 #define HID_MOUSE_EP                3
 #define HID_MOUSE_INT_OUT_EP_SIZE   3
-#define HID_MOUSE_INT_IN_EP_SIZE    3
-#define HID_RPT03_SIZE              52
-
-#define HID_NUM_OF_DSC              1
+#define HID_MOUSE_INT_IN_EP_SIZE    4   // buttons, X, Y and wheel
+#define HID_RPT03_SIZE              89
 
+/* HID - Telemetry and settings (vendor defined, feature reports only) */
 #ifndef ENABLE_MOUSE
-#define HID_NUM_OF_INTF             2
+#define HID_TELEMETRY_INTF_ID       0x02
 #else
-#define HID_NUM_OF_INTF             3
+#define HID_TELEMETRY_INTF_ID       0x03
 #endif
+#define HID_TELEMETRY_EP            4
+#define HID_TELEMETRY_INT_IN_EP_SIZE 8
+#define HID_RPT04_SIZE              39
+
+#define HID_NUM_OF_DSC              1
+
+#define HID_NUM_OF_INTF             (HID_TELEMETRY_INTF_ID + 1)
 
 /** DEFINITIONS ****************************************************/
 
@@ -96,13 +96,8 @@ const uint8_t configDescriptor1[]={
     /* Configuration Descriptor */
     USB_CFG_DSC_SIZE,       // Size of this descriptor in bytes
     USB_DESCRIPTOR_CONFIGURATION,                // CONFIGURATION descriptor type
-#ifndef ENABLE_MOUSE
-    DESC_CONFIG_WORD(USB_CFG_DSC_SIZE + USB_HID_DESC_SIZE + USB_EP_DSC_SIZE + USB_HID_DESC_SIZE), // Total length of data for this cfg
-    2,                      // Number of interfaces in this cfg
-#else
-    DESC_CONFIG_WORD(USB_CFG_DSC_SIZE + USB_HID_DESC_SIZE + USB_EP_DSC_SIZE + USB_HID_DESC_SIZE + USB_HID_DESC_SIZE), // Total length of data for this cfg
-    3,                      // Number of interfaces in this cfg
-#endif
+    DESC_CONFIG_WORD(USB_CFG_DSC_SIZE + USB_HID_DESC_SIZE * HID_NUM_OF_INTF + USB_EP_DSC_SIZE), // Total length of data for this cfg
+    HID_NUM_OF_INTF,        // Number of interfaces in this cfg
     1,                      // Index value of this configuration
     0,                      // Configuration string index
     _DEFAULT | _RWU,        // Attributes, see usb_device.h
@@ -136,7 +131,7 @@ const uint8_t configDescriptor1[]={
     HID_EP | _EP_IN,            //EndpointAddress
     _INTERRUPT,                       //Attributes
     DESC_CONFIG_WORD(8),        //size
-    0x01,                        //Interval
+    HID_IN_INTERVAL,            //Interval
 
 // USB_HID_DESC_SIZE
 
@@ -176,7 +171,7 @@ const uint8_t configDescriptor1[]={
     HID_CC_EP | _EP_IN,            //EndpointAddress
     _INTERRUPT,                       //Attributes
     DESC_CONFIG_WORD(4),                  //size
-    0x01,                       //Interval
+    HID_IN_INTERVAL,            //Interval
 
 // USB_HID_DESC_SIZE
 
@@ -206,12 +201,42 @@ const uint8_t configDescriptor1[]={
     USB_DESCRIPTOR_ENDPOINT,    //Endpoint Descriptor
     HID_MOUSE_EP | _EP_IN,            //EndpointAddress
     _INTERRUPT,                       //Attributes
-    DESC_CONFIG_WORD(4),                  //size
-    0x01                        //Interval
+    DESC_CONFIG_WORD(HID_MOUSE_INT_IN_EP_SIZE), //size
+    HID_MOUSE_IN_INTERVAL,      //Interval
 
 // USB_HID_DESC_SIZE
 
 #endif
+
+    /* Interface Descriptor */
+    USB_INTF_DSC_SIZE,      // Size of this descriptor in bytes
+    USB_DESCRIPTOR_INTERFACE,               // INTERFACE descriptor type
+    HID_TELEMETRY_INTF_ID,  // Interface Number
+    0,                      // Alternate Setting Number
+    1,                      // Number of endpoints in this intf
+    HID_INTF,               // Class code
+    0,                      // Subclass code
+    HID_PROTOCOL_NONE,      // Protocol code
+    0,                      // Interface string index
+
+    /* HID Class-Specific Descriptor */
+    0x09,//sizeof(USB_HID_DSC)+3,    // Size of this descriptor in bytes RRoj hack
+    DSC_HID,                // HID descriptor type
+    DESC_CONFIG_WORD(0x0111),                 // HID Spec Release Number in BCD format (1.11)
+    0x00,                   // Country Code (0x00 for Not supported)
+    HID_NUM_OF_DSC,         // Number of class descriptors, see usbcfg.h
+    DSC_RPT,                // Report descriptor type
+    DESC_CONFIG_WORD(HID_RPT04_SIZE),   // Size of the report descriptor
+
+    /* Endpoint Descriptor */
+    0x07,/*sizeof(USB_EP_DSC)*/
+    USB_DESCRIPTOR_ENDPOINT,    //Endpoint Descriptor
+    HID_TELEMETRY_EP | _EP_IN,  //EndpointAddress
+    _INTERRUPT,                       //Attributes
+    DESC_CONFIG_WORD(HID_TELEMETRY_INT_IN_EP_SIZE), //size
+    0xFF                        //Interval; never used
+
+// USB_HID_DESC_SIZE
 };
 
 //Language code string descriptor
@@ -81,6 +81,9 @@ void LED_Initialize(void)
         led1Port = led2Port = &LATC;
         led1Bit = 1u << 0;
         led2Bit = 1u << 1;
+    } else {
+        // The Num Lock LED is too bright on the older boards.
+        LED_SetLevel(LED_D1, 1);
     }
     LED_On(LED_D1);
     LED_On(LED_D2);
@@ -122,54 +125,27 @@ static void LED_Clear(LED led)
 }
 
 /*********************************************************************
-* Function: void LED_On(LED led);
+* Function: void LED_Drive(LED led, bool lit);
 *
-* Overview: Turns requested LED on
+* Overview: Lights or darkens the requested LED for the LED sequencer
 *
-* PreCondition: LED configured via LED_Configure()
+* PreCondition: LED configured via LED_Initialize()
 *
-* Input: LED led - enumeration of the LEDs available in this
-*        demo.  They should be meaningful names and not the names of
-*        the LEDs on the silkscreen on the board (as the demo code may
-*        be ported to other boards).
-*         i.e. - LED_On(LED_CONNECTION_DETECTED);
+* Input: LED led - the LED to drive.
+*        bool lit - true to light the LED.
 *
 * Output: none
 *
 ********************************************************************/
-void LED_On(LED led)
+void LED_Drive(LED led, bool lit)
 {
-    if (2 <= BOARD_REV_VALUE)
+    // The LEDs are active low on the boards older than rev. 2.
+    if (lit == (2 <= BOARD_REV_VALUE))
         LED_Set(led);
     else
         LED_Clear(led);
 }
 
-/*********************************************************************
-* Function: void LED_Off(LED led);
-*
-* Overview: Turns requested LED off
-*
-* PreCondition: LED configured via LEDConfigure()
-*
-* Input: LED led - enumeration of the LEDs available in this
-*        demo.  They should be meaningful names and not the names of
-*        the LEDs on the silkscreen on the board (as the demo code may
-*        be ported to other boards).
-*         i.e. - LED_Off(LED_CONNECTION_DETECTED);
-*
-* Output: none
-*
-********************************************************************/
-void LED_Off(LED led)
-{
-    if (2 <= BOARD_REV_VALUE)
-        LED_Clear(led);
-    else
-        LED_Set(led);
-}
-
-
 /*******************************************************************************
  End of File
 */
@@ -25,4 +25,9 @@
 #define ReadNvram(offset)           eeprom_read(offset)
 #define WriteNvram(offset, value)   eeprom_write(offset, value)
 
+// There is just one profile in EEPROM.
+#define NVRAM_PROFILE_MAX           1
+#define CurrentProfile()            0
+#define SyncNvram()
+
 #endif //NVRAM_H
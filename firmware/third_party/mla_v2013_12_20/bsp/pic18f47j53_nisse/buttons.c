@@ -16,6 +16,7 @@
 
 #include <system.h>
 #include <buttons.h>
+#include <pps.h>
 
 bool BUTTON_IsPressed()
 {
@@ -33,3 +34,60 @@ bool BUTTON_IsPressed()
     TRISD &= ~COLUMN_RD_BITS;
     return pressed;
 }
+
+// With GIE cleared, a wake-up flag stays set until cleared here, and Sleep()
+// would then return at once.
+void BUTTON_ClearWakeUpFlags(void)
+{
+    (void) PORTB;   // End the mismatch condition of RB4-RB7.
+    INTCONbits.RBIF = 0;
+    INTCONbits.INT0IF = 0;
+    INTCON3bits.INT1IF = 0;
+    INTCON3bits.INT2IF = 0;
+    INTCON3bits.INT3IF = 0;
+}
+
+// The columns on RB0-RB3 wake up the MCU through INT0-INT3 and the ones on
+// RB5-RB7 through interrupt-on-change. The columns on PORTD have no interrupt
+// source and have to be checked at each WDT wake-up.
+void BUTTON_EnableWakeUp(void)
+{
+    INTCON2bits.RBPU = 0;
+    TRISEbits.RDPU = 1;
+    TRISB |= COLUMN_RB_BITS;
+    TRISD |= COLUMN_RD_BITS;
+
+    PPSUnLock();
+    iPPSInput(IN_FN_PPS_INT1, IN_PIN_PPS_RP4);  // RB1
+    iPPSInput(IN_FN_PPS_INT2, IN_PIN_PPS_RP5);  // RB2
+    iPPSInput(IN_FN_PPS_INT3, IN_PIN_PPS_RP6);  // RB3
+    PPSLock();
+
+    // Falling edges
+    INTCON2bits.INTEDG0 = 0;
+    INTCON2bits.INTEDG1 = 0;
+    INTCON2bits.INTEDG2 = 0;
+    INTCON2bits.INTEDG3 = 0;
+
+    BUTTON_ClearWakeUpFlags();
+    INTCONbits.RBIE = 1;
+    INTCONbits.INT0IE = 1;
+    INTCON3bits.INT1IE = 1;
+    INTCON3bits.INT2IE = 1;
+    INTCON3bits.INT3IE = 1;
+}
+
+void BUTTON_DisableWakeUp(void)
+{
+    INTCONbits.RBIE = 0;
+    INTCONbits.INT0IE = 0;
+    INTCON3bits.INT1IE = 0;
+    INTCON3bits.INT2IE = 0;
+    INTCON3bits.INT3IE = 0;
+    BUTTON_ClearWakeUpFlags();
+
+    TRISEbits.RDPU = 0;
+    INTCON2bits.RBPU = 1;
+    TRISB &= ~COLUMN_RB_BITS;
+    TRISD &= ~COLUMN_RD_BITS;
+}
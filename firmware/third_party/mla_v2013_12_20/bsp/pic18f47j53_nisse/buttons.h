@@ -50,4 +50,13 @@
 // Returns true if any one of the keys is pressed
 bool BUTTON_IsPressed();
 
+// Keeps the columns pulled up so that a key press wakes up the MCU from Sleep()
+#define BUTTON_HAS_WAKE_UP
+void BUTTON_EnableWakeUp(void);
+void BUTTON_DisableWakeUp(void);
+void BUTTON_ClearWakeUpFlags(void);     // after each wake-up from Sleep()
+
+// Returns true if any one of the keys is pressed while BUTTON_EnableWakeUp() is in effect
+#define BUTTON_IsDown()     ((~PORTD & COLUMN_RD_BITS) || (~PORTB & COLUMN_RB_BITS))
+
 #endif // BUTTONS_H
@@ -117,45 +117,51 @@ static void LED_Clear(LED led)
 }
 
 /*********************************************************************
-* Function: void LED_On(LED led);
+* Function: void LED_Drive(LED led, bool lit);
 *
-* Overview: Turns requested LED on
+* Overview: Lights or darkens the requested LED for the LED sequencer
 *
-* PreCondition: LED configured via LED_Configure()
+* PreCondition: LED configured via LED_Initialize()
 *
-* Input: LED led - enumeration of the LEDs available in this
-*        demo.  They should be meaningful names and not the names of
-*        the LEDs on the silkscreen on the board (as the demo code may
-*        be ported to other boards).
-*         i.e. - LED_On(LED_CONNECTION_DETECTED);
+* Input: LED led - the LED to drive.
+*        bool lit - true to light the LED.
 *
 * Output: none
 *
 ********************************************************************/
-void LED_On(LED led)
+void LED_Drive(LED led, bool lit)
 {
-    LED_Set(led);
+    if (lit)
+        LED_Set(led);
+    else
+        LED_Clear(led);
 }
 
 /*********************************************************************
-* Function: void LED_Off(LED led);
+* Function: bool LED_Get(LED led);
 *
-* Overview: Turns requested LED off
+* Overview: Returns the current state of the requested LED
 *
 * PreCondition: LED configured via LEDConfigure()
 *
 * Input: LED led - enumeration of the LEDs available in this
-*        demo.  They should be meaningful names and not the names of
-*        the LEDs on the silkscreen on the board (as the demo code may
-*        be ported to other boards).
-*         i.e. - LED_Off(LED_CONNECTION_DETECTED);
+*        demo.
 *
-* Output: none
+* Output: true if on, false if off
 *
 ********************************************************************/
-void LED_Off(LED led)
+bool LED_Get(LED led)
 {
-    LED_Clear(led);
+    switch (led) {
+    case LED_D1:
+        return (*led1Port & led1Bit) ? true : false;
+    case LED_D2:
+        return (*led2Port & led2Bit) ? true : false;
+    case LED_D3:
+        return (*led3Port & led3Bit) ? true : false;
+    default:
+        return false;
+    }
 }
 
 
@@ -32,6 +32,7 @@
 #define LEDS_H
 
 #include <stdbool.h>
+#include <stdint.h>
 
 /** Type defintions *********************************/
 typedef enum
@@ -44,6 +45,14 @@ typedef enum
 
 #define LED_COUNT 3
 
+#define LED_LEVEL_MAX 4     // brightness steps, in quarters of the LED_Pulse() period
+
+typedef struct
+{
+    uint8_t on;             // ticks on; 0 for steady off
+    uint8_t off;            // ticks off; 0 for steady on
+} LED_PATTERN;
+
 void LED_Initialize(void);
 
 /*********************************************************************
@@ -82,5 +91,102 @@ void LED_On(LED led);
 ********************************************************************/
 void LED_Off(LED led);
 
+/*********************************************************************
+* Function: bool LED_Get(LED led);
+*
+* Overview: Returns the current state of the requested LED
+*
+* PreCondition: LED configured via LEDConfigure()
+*
+* Input: LED led - enumeration of the LEDs available in this
+*        demo.
+*
+* Output: true if on, false if off
+*
+********************************************************************/
+bool LED_Get(LED led);
+
+/*********************************************************************
+* Function: void LED_SetLevel(LED led, uint8_t level);
+*
+* Overview: Sets the brightness of the requested LED
+*
+* PreCondition: LED configured via LED_Initialize()
+*
+* Input: LED led - the LED to dim.
+*        uint8_t level - 0 (dark) to LED_LEVEL_MAX (full).  Levels
+*        below LED_LEVEL_MAX take effect as LED_Pulse() is called.
+*
+* Output: none
+*
+********************************************************************/
+void LED_SetLevel(LED led, uint8_t level);
+
+/*********************************************************************
+* Function: void LED_SetPattern(LED led, const LED_PATTERN* pattern);
+*
+* Overview: Blinks the requested LED with the given pattern
+*
+* PreCondition: LED configured via LED_Initialize()
+*
+* Input: LED led - the LED to blink.
+*        const LED_PATTERN* pattern - the pattern to follow, or NULL
+*        to go back to LED_On()/LED_Off().  Setting the current
+*        pattern again keeps its phase.  LED_On() and LED_Off()
+*        cancel the pattern.
+*
+* Output: none
+*
+********************************************************************/
+void LED_SetPattern(LED led, const LED_PATTERN* pattern);
+
+/*********************************************************************
+* Function: void LED_Tick(void);
+*
+* Overview: Advances the blink patterns, and lights the LEDs that are
+*           on to start their on-pulses
+*
+* PreCondition: LED configured via LED_Initialize()
+*
+* Input: none
+*
+* Output: none
+*
+********************************************************************/
+void LED_Tick(void);
+
+/*********************************************************************
+* Function: bool LED_Pulse(uint16_t elapsed, uint16_t period);
+*
+* Overview: Ends the on-pulses of the LEDs dimmed below LED_LEVEL_MAX;
+*           an LED at level n stays lit for n / LED_LEVEL_MAX of the
+*           period from the last LED_Tick().
+*
+* PreCondition: LED_Tick() called at the start of the tick
+*
+* Input: uint16_t elapsed - time since the last LED_Tick().
+*        uint16_t period - the pulse period in the same unit.
+*
+* Output: true while any dimmed LED is still lit
+*
+********************************************************************/
+bool LED_Pulse(uint16_t elapsed, uint16_t period);
+
+/*********************************************************************
+* Function: void LED_Drive(LED led, bool lit);
+*
+* Overview: Lights or darkens the requested LED.  Provided by each
+*           board for the LED sequencer in src/LedSequencer.c.
+*
+* PreCondition: LED configured via LED_Initialize()
+*
+* Input: LED led - the LED to drive.
+*        bool lit - true to light the LED.
+*
+* Output: none
+*
+********************************************************************/
+void LED_Drive(LED led, bool lit);
+
 
 #endif //LEDS_H
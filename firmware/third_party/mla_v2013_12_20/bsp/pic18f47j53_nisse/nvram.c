@@ -26,7 +26,7 @@
 #define NVRAM_MAX       (NVRAM_SIZE / NVRAM_BLOCK)
 
 #define PROFILE_SIZE    10
-#define PROFILE_MAX     4
+#define PROFILE_MAX     NVRAM_PROFILE_MAX
 
 typedef struct Profile {
     uint8_t data[PROFILE_SIZE];
@@ -34,7 +34,7 @@ typedef struct Profile {
 
 typedef struct Profiles {
     Profile profiles[PROFILE_MAX];
-    uint8_t reserved[NVRAM_BLOCK - (PROFILE_SIZE * PROFILE_MAX + 2)];
+    uint8_t common[NVRAM_COMMON_SIZE];
     uint8_t current_profile;
     uint8_t sig;    // 0x01: flashed, 0xff: erased
 } Profiles;
@@ -42,6 +42,8 @@ typedef struct Profiles {
 static const uint8_t nvramArray[NVRAM_SIZE] @ NVRAM_ADDRESS;    // Note __at() seems not working here with xc8 v1.34
 static int8_t current = -1;
 static Profiles shadow;
+static Profile* profile = shadow.profiles;  // points to the current profile in shadow
+static uint8_t saved_profile;               // current_profile in the flash
 
 static void PutNvram(void)
 {
@@ -53,6 +55,7 @@ static void PutNvram(void)
     }
 
     shadow.sig = 0x01;
+    saved_profile = shadow.current_profile;
     if (NVRAM_MAX <= ++current) {
         EraseFlash(NVRAM_ADDRESS, NVRAM_ADDRESS + NVRAM_SIZE);
         current = 0;
@@ -80,28 +83,82 @@ void InitNvram(void)
             memcpy(shadow.profiles[i].data, nvram_initial_data, NVRAM_INITIAL_DATA_SIZE);
             memset(shadow.profiles[i].data + NVRAM_INITIAL_DATA_SIZE, 0, PROFILE_SIZE - NVRAM_INITIAL_DATA_SIZE);
         }
+        memset(shadow.common, 0, NVRAM_COMMON_SIZE);
     } else
         ReadFlash(NVRAM_ADDRESS + NVRAM_BLOCK * current, NVRAM_BLOCK, (void*) &shadow);
+    profile = &shadow.profiles[shadow.current_profile];
+    saved_profile = shadow.current_profile;
 }
 
 uint8_t ReadNvram(uint8_t offset)
 {
-    return shadow.profiles[shadow.current_profile].data[offset];
+    return profile->data[offset];
 }
 
 void WriteNvram(uint8_t offset, uint8_t value)
 {
-    shadow.profiles[shadow.current_profile].data[offset] = value;
+    if (profile->data[offset] == value)
+        return;
+    profile->data[offset] = value;
     PutNvram();
 }
 
-void SelectProfile(uint8_t profile)
+void SelectProfile(uint8_t p)
 {
-    shadow.current_profile = profile;
-    PutNvram();
+    // All the profiles are kept in shadow, so switching is just a pointer
+    // update. The selection is written to the flash later by SyncNvram() or
+    // along with the next write.
+    if (PROFILE_MAX <= p)
+        return;
+    shadow.current_profile = p;
+    profile = &shadow.profiles[p];
+}
+
+void SyncNvram(void)
+{
+    if (saved_profile != shadow.current_profile)
+        PutNvram();
 }
 
 uint8_t CurrentProfile(void)
 {
     return shadow.current_profile;
 }
+
+void ReadNvramProfiles(uint8_t* data, uint8_t len)
+{
+    for (int8_t i = 0; i < PROFILE_MAX; ++i, data += len)
+        memcpy(data, shadow.profiles[i].data, len);
+}
+
+void WriteNvramProfiles(const uint8_t* data, uint8_t len, uint8_t selected)
+{
+    bool modified = false;
+
+    for (int8_t i = 0; i < PROFILE_MAX; ++i, data += len) {
+        if (memcmp(shadow.profiles[i].data, data, len)) {
+            memcpy(shadow.profiles[i].data, data, len);
+            modified = true;
+        }
+    }
+    if (selected < PROFILE_MAX && shadow.current_profile != selected) {
+        shadow.current_profile = selected;
+        profile = &shadow.profiles[selected];
+        modified = true;
+    }
+    if (modified)
+        PutNvram();
+}
+
+void ReadNvramCommon(uint8_t offset, void* data, uint8_t len)
+{
+    memcpy(data, shadow.common + offset, len);
+}
+
+void WriteNvramCommon(uint8_t offset, const void* data, uint8_t len)
+{
+    if (!memcmp(shadow.common + offset, data, len))
+        return;
+    memcpy(shadow.common + offset, data, len);
+    PutNvram();
+}
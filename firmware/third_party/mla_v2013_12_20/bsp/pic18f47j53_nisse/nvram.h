@@ -30,8 +30,27 @@ void InitNvram(void);
 uint8_t ReadNvram(uint8_t offset);
 void WriteNvram(uint8_t offset, uint8_t value);
 
+// SelectProfile() switches the profile in RAM only; SyncNvram() saves the
+// selection to the flash, e.g., before going to sleep.
 void SelectProfile(uint8_t profile);
 uint8_t CurrentProfile(void);
+void SyncNvram(void);
+
+// All the profiles at once: data holds len bytes from the start of each of
+// the NVRAM_PROFILE_MAX profiles in order. WriteNvramProfiles() also selects
+// the current profile, and writes the flash block at most once.
+#define NVRAM_PROFILE_MAX       4
+
+void ReadNvramProfiles(uint8_t* data, uint8_t len);
+void WriteNvramProfiles(const uint8_t* data, uint8_t len, uint8_t selected);
+
+// Common area shared by all the profiles
+#define NVRAM_COMMON_SIZE       22
+#define NVRAM_COMMON_HOS_INFO   0   // 4 bytes; BLE module revision and version
+#define NVRAM_COMMON_HOS_SPI    4   // 1 byte; SPI setting selected by HosTuneSPI()
+
+void ReadNvramCommon(uint8_t offset, void* data, uint8_t len);
+void WriteNvramCommon(uint8_t offset, const void* data, uint8_t len);
 
 extern const uint8_t nvram_initial_data[NVRAM_INITIAL_DATA_SIZE];
 
@@ -96,6 +96,7 @@ extern const struct{uint8_t report[HID_RPT02_SIZE];}hid_rpt02;
 #ifdef ENABLE_MOUSE
 extern const struct{uint8_t report[HID_RPT03_SIZE];}hid_rpt03;
 #endif
+extern const struct{uint8_t report[HID_RPT04_SIZE];}hid_rpt04;
 
 // *****************************************************************************
 // *****************************************************************************
@@ -186,18 +187,24 @@ void USBCheckHIDRequest(void)
                     }
                     else if (SetupPkt.bIntfID == HID_CC_INTF_ID) {
                         USBEP0SendROMPtr(
-                            (const uint8_t*)&configDescriptor1 + 41,		//41 is a magic number.  It is the offset from start of the configuration descriptor to the start of the HID descriptor.
+                            (const uint8_t*)&configDescriptor1 + 50,		//50 is a magic number.  It is the offset from start of the configuration descriptor to the start of the HID descriptor.
                             sizeof(USB_HID_DSC)+3,
                             USB_EP0_INCLUDE_ZERO);
                     }
 #ifdef ENABLE_MOUSE
                     else if (SetupPkt.bIntfID == HID_MOUSE_INTF_ID) {
                         USBEP0SendROMPtr(
-                            (const uint8_t*)&configDescriptor1 + 66,		//66 is a magic number.  It is the offset from start of the configuration descriptor to the start of the HID descriptor.
+                            (const uint8_t*)&configDescriptor1 + 75,		//75 is a magic number.  It is the offset from start of the configuration descriptor to the start of the HID descriptor.
                             sizeof(USB_HID_DSC)+3,
                             USB_EP0_INCLUDE_ZERO);
                     }
 #endif
+                    else if (SetupPkt.bIntfID == HID_TELEMETRY_INTF_ID) {
+                        USBEP0SendROMPtr(
+                            (const uint8_t*)&configDescriptor1 + 50 + 25 * (HID_TELEMETRY_INTF_ID - 1),	//Each interface after the keyboard takes 25 bytes.
+                            sizeof(USB_HID_DSC)+3,
+                            USB_EP0_INCLUDE_ZERO);
+                    }
                 }
                 break;
             case DSC_RPT:  //Report Descriptor
@@ -223,6 +230,12 @@ void USBCheckHIDRequest(void)
                             USB_EP0_INCLUDE_ZERO);
                     }
 #endif
+                    else if(SetupPkt.bIntfID == HID_TELEMETRY_INTF_ID) {
+                        USBEP0SendROMPtr(
+                            (const uint8_t*)&hid_rpt04,
+                            HID_RPT04_SIZE,     //See usbcfg.h
+                            USB_EP0_INCLUDE_ZERO);
+                    }
                 }
                 break;
             case DSC_PHY:  //Physical Descriptor
@@ -283,6 +296,24 @@ void USBCheckHIDRequest(void)
 
 }//end USBCheckHIDRequest
 
+void USBHIDInitialize(void)
+{
+    for (uint8_t i = 0; i < HID_NUM_OF_INTF; ++i) {
+        idle_rate[i] = 0;
+        active_protocol[i] = HID_REPORT_PROTOCOL;
+    }
+}
+
+uint8_t USBHIDGetIdleRate(uint8_t intf)
+{
+    return idle_rate[intf];
+}
+
+uint8_t USBHIDGetProtocol(uint8_t intf)
+{
+    return active_protocol[intf];
+}
+
 /********************************************************************
     Function:
         USB_HANDLE HIDTxPacket(uint8_t ep, uint8_t* data, uint16_t len)
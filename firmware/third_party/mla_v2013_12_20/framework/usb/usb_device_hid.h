@@ -61,6 +61,10 @@ CONSEQUENTIAL DAMAGES, FOR ANY REASON WHATSOEVER.
 #define HID_PROTOCOL_KEYBOARD       0x01
 #define HID_PROTOCOL_MOUSE          0x02
 
+/* HID Protocols selected by SET_PROTOCOL */
+#define HID_BOOT_PROTOCOL           0x00
+#define HID_REPORT_PROTOCOL         0x01
+
 /********************************************************************
 	Function:
 		void USBCheckHIDRequest(void)
@@ -101,6 +105,64 @@ CONSEQUENTIAL DAMAGES, FOR ANY REASON WHATSOEVER.
  *******************************************************************/
 void USBCheckHIDRequest(void);
 
+/********************************************************************
+	Function:
+		void USBHIDInitialize(void)
+
+ 	Summary:
+ 		Resets the idle rate and the protocol of every HID interface.
+
+ 	Description:
+ 		Resets the idle rate of every HID interface to zero (report only
+        on change) and the protocol to HID_REPORT_PROTOCOL as the host
+        expects after the device is configured.  Call this function when
+        the device is configured.
+
+	PreCondition:
+		None
+
+	Parameters:
+		None
+
+	Return Values:
+		None
+
+	Remarks:
+		None
+
+ *******************************************************************/
+void USBHIDInitialize(void);
+
+/********************************************************************
+	Function:
+		uint8_t USBHIDGetIdleRate(uint8_t intf)
+		uint8_t USBHIDGetProtocol(uint8_t intf)
+
+ 	Summary:
+ 		Return the idle rate and the protocol set by the host.
+
+ 	Description:
+ 		USBHIDGetIdleRate() returns the idle rate set by SET_IDLE in 4
+        msec units; zero means the report is sent only when it changes.
+        USBHIDGetProtocol() returns HID_BOOT_PROTOCOL or
+        HID_REPORT_PROTOCOL set by SET_PROTOCOL.
+
+	PreCondition:
+		None
+
+	Parameters:
+		uint8_t intf - the HID interface number
+
+	Return Values:
+		The idle rate or the protocol
+
+	Remarks:
+		None
+
+ *******************************************************************/
+uint8_t USBHIDGetIdleRate(uint8_t intf);
+uint8_t USBHIDGetProtocol(uint8_t intf);
+
 /********************************************************************
     Function:
         bool HIDTxHandleBusy(USB_HANDLE handle)
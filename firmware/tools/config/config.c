@@ -0,0 +1,323 @@
+/*
+ * Copyright 2026 Esrille Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/*
+ * config - read and write the keyboard settings over the vendor interface
+ *
+ * The USB firmware exposes the settings of every profile, EEPROM_BASE to
+ * EEPROM_PREFIX of src/Keyboard.h, as a single FEATURE report on the
+ * vendor defined HID interface (see app_device_config.c), so a keyboard is
+ * read or provisioned in one control transfer each instead of through the
+ * text typed by Fn+F1 to F9:
+ *
+ *   config [-d /dev/hidrawN]                 print the settings
+ *   config [-d ...] -o file                  save the settings to file
+ *   config [-d ...] -i file                  write the settings saved in file
+ *   config [-d ...] [-p profile] [-c current] [name=value...]
+ *                                            change some settings
+ *
+ * The names are base, kana, os, delay, mod, led, ime, mouse and prefix; the
+ * values are the numbers of the EEPROM_* fields, e.g., os=4 for OS_109.
+ * -p selects the profile to change (the current one by default) and -c
+ * the profile to make current. The settings are read back after writing.
+ * Without -d, the first hidraw device with the vendor report descriptor
+ * is used.
+ *
+ * Build in firmware/:
+ *
+ *   cc -O2 -o config tools/config/config.c
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <linux/hidraw.h>
+#include <sys/ioctl.h>
+
+#define CONFIG_VERSION          1
+#define CONFIG_REPORT_SETTINGS  3
+#define CONFIG_PROFILE_MAX      4
+
+#define CONFIG_OK               0
+#define CONFIG_BUSY             1
+#define CONFIG_REJECTED         2
+
+#define SETTINGS_SIZE           9   // EEPROM_SETTINGS
+#define HIDRAW_MAX              64
+#define BUSY_RETRIES            100
+
+typedef struct __attribute__((packed)) {
+    uint8_t id;
+    uint8_t version;
+    uint8_t status;
+    uint8_t profiles;
+    uint8_t current;
+    uint8_t size;
+    uint8_t settings[CONFIG_PROFILE_MAX][SETTINGS_SIZE];
+} Settings;
+
+static const char* const names[SETTINGS_SIZE] = {
+    "base", "kana", "os", "delay", "mod", "led", "ime", "mouse", "prefix"
+};
+
+// The first bytes of the report descriptor of the vendor interface
+static const uint8_t signature[] = {
+    0x06, 0x00, 0xFF,   // Usage Page (Vendor Defined 0xFF00)
+    0x09, 0x01,         // Usage (1)
+    0xA1, 0x01,         // Collection (Application)
+};
+
+static bool isVendor(int fd)
+{
+    struct hidraw_report_descriptor desc;
+
+    if (ioctl(fd, HIDIOCGRDESCSIZE, &desc.size) < 0 || desc.size < sizeof signature)
+        return false;
+    if (ioctl(fd, HIDIOCGRDESC, &desc) < 0)
+        return false;
+    return memcmp(desc.value, signature, sizeof signature) == 0;
+}
+
+static int openDevice(const char* path)
+{
+    char name[32];
+    int fd;
+
+    if (path) {
+        fd = open(path, O_RDWR);
+        if (fd < 0) {
+            perror(path);
+            return -1;
+        }
+        if (!isVendor(fd)) {
+            fprintf(stderr, "%s: not the keyboard vendor interface\n", path);
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+    for (int i = 0; i < HIDRAW_MAX; ++i) {
+        snprintf(name, sizeof name, "/dev/hidraw%d", i);
+        fd = open(name, O_RDWR);
+        if (fd < 0)
+            continue;
+        if (isVendor(fd))
+            return fd;
+        close(fd);
+    }
+    fprintf(stderr, "config: no keyboard vendor interface found\n");
+    return -1;
+}
+
+// Read the settings, waiting while the last ones are being written.
+static int readSettings(int fd, Settings* s)
+{
+    for (int i = 0; i < BUSY_RETRIES; ++i) {
+        memset(s, 0, sizeof *s);
+        s->id = CONFIG_REPORT_SETTINGS;
+        if (ioctl(fd, HIDIOCGFEATURE(sizeof *s), s) < (int) sizeof *s) {
+            perror("HIDIOCGFEATURE");
+            return -1;
+        }
+        if (s->status != CONFIG_BUSY)
+            break;
+        usleep(10000);
+    }
+    if (s->id != CONFIG_REPORT_SETTINGS || s->version != CONFIG_VERSION ||
+        s->size != SETTINGS_SIZE || CONFIG_PROFILE_MAX < s->profiles) {
+        fprintf(stderr, "config: unknown settings report version %u\n", s->version);
+        return -1;
+    }
+    if (s->status == CONFIG_BUSY) {
+        fprintf(stderr, "config: the keyboard is busy\n");
+        return -1;
+    }
+    return 0;
+}
+
+static int writeSettings(int fd, const Settings* s)
+{
+    Settings check;
+
+    if (ioctl(fd, HIDIOCSFEATURE(sizeof *s), s) < (int) sizeof *s) {
+        perror("HIDIOCSFEATURE");
+        return -1;
+    }
+    if (readSettings(fd, &check) < 0)
+        return -1;
+    if (check.status == CONFIG_REJECTED) {
+        fprintf(stderr, "config: the keyboard rejected a value out of range\n");
+        return -1;
+    }
+    if (memcmp(check.settings, s->settings, check.profiles * sizeof s->settings[0]) ||
+        (s->current != 0xff && s->current < check.profiles && check.current != s->current)) {
+        fprintf(stderr, "config: the settings did not read back\n");
+        return -1;
+    }
+    return 0;
+}
+
+static void printSettings(const Settings* s)
+{
+    for (int p = 0; p < s->profiles; ++p) {
+        printf("%c%d", (p == s->current) ? '*' : ' ', p);
+        for (int i = 0; i < SETTINGS_SIZE; ++i)
+            printf(" %s=%u", names[i], s->settings[p][i]);
+        printf("\n");
+    }
+}
+
+static int setField(Settings* s, int profile, const char* arg)
+{
+    const char* eq = strchr(arg, '=');
+    char* end;
+    long value;
+
+    if (!eq)
+        return -1;
+    value = strtol(eq + 1, &end, 0);
+    if (*end || value < 0 || 255 < value)
+        return -1;
+    for (int i = 0; i < SETTINGS_SIZE; ++i) {
+        if (strlen(names[i]) == (size_t) (eq - arg) && !strncmp(names[i], arg, eq - arg)) {
+            s->settings[profile][i] = value;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static int saveFile(const char* path, const Settings* s)
+{
+    FILE* file = fopen(path, "wb");
+
+    if (!file || fwrite(s, sizeof *s, 1, file) != 1) {
+        perror(path);
+        if (file)
+            fclose(file);
+        return -1;
+    }
+    return fclose(file);
+}
+
+static int loadFile(const char* path, Settings* s)
+{
+    FILE* file = fopen(path, "rb");
+
+    if (!file || fread(s, sizeof *s, 1, file) != 1) {
+        perror(path);
+        if (file)
+            fclose(file);
+        return -1;
+    }
+    fclose(file);
+    if (s->id != CONFIG_REPORT_SETTINGS || s->version != CONFIG_VERSION || s->size != SETTINGS_SIZE) {
+        fprintf(stderr, "%s: not a settings file\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "usage: config [-d /dev/hidrawN] [-o file | -i file | [-p profile] [-c current] [name=value...]]\n");
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char* argv[])
+{
+    const char* device = NULL;
+    const char* output = NULL;
+    const char* input = NULL;
+    int profile = -1;
+    int current = -1;
+    Settings s;
+    int opt;
+    int fd;
+
+    while ((opt = getopt(argc, argv, "d:o:i:p:c:")) != -1) {
+        switch (opt) {
+        case 'd':
+            device = optarg;
+            break;
+        case 'o':
+            output = optarg;
+            break;
+        case 'i':
+            input = optarg;
+            break;
+        case 'p':
+            profile = atoi(optarg);
+            break;
+        case 'c':
+            current = atoi(optarg);
+            break;
+        default:
+            usage();
+        }
+    }
+    if ((output || input) && (optind < argc || 0 <= profile || 0 <= current || (output && input)))
+        usage();
+
+    fd = openDevice(device);
+    if (fd < 0)
+        return EXIT_FAILURE;
+    if (readSettings(fd, &s) < 0)
+        return EXIT_FAILURE;
+
+    if (output)
+        return saveFile(output, &s) ? EXIT_FAILURE : EXIT_SUCCESS;
+
+    if (input) {
+        uint8_t profiles = s.profiles;
+        if (loadFile(input, &s) < 0)
+            return EXIT_FAILURE;
+        if (s.profiles != profiles) {
+            fprintf(stderr, "config: %s has %u profiles; the keyboard has %u\n", input, s.profiles, profiles);
+            return EXIT_FAILURE;
+        }
+    } else if (optind < argc || 0 <= current) {
+        if (profile < 0)
+            profile = s.current;
+        if (s.profiles <= profile || (0 <= current && s.profiles <= current)) {
+            fprintf(stderr, "config: no such profile\n");
+            return EXIT_FAILURE;
+        }
+        for (int i = optind; i < argc; ++i) {
+            if (setField(&s, profile, argv[i]) < 0) {
+                fprintf(stderr, "config: bad setting '%s'\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        }
+        s.current = (0 <= current) ? current : 0xff;
+    } else {
+        printSettings(&s);
+        return EXIT_SUCCESS;
+    }
+
+    if (writeSettings(fd, &s) < 0 || readSettings(fd, &s) < 0)
+        return EXIT_FAILURE;
+    printSettings(&s);
+    close(fd);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,537 @@
+/*
+ * Copyright 2026 Esrille Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/*
+ * flash - update the keyboard firmware, rewriting only the pages that changed
+ *
+ * The HID bootloaders (BootPIC18NonJ.c and boot_18fxxjxx.c) version 1.03 or
+ * later can return the CRC-16 of many flash blocks in one packet
+ * (GET_CHECKSUMS), and can erase and program one whole erase page from a
+ * page buffer (LOAD_PAGE and WRITE_PAGE). This tool compares the CRC of
+ * every erase page of the application with the new image, and erases and
+ * rewrites only the pages that differ, so an unchanged image takes a few
+ * packets and no flash wear:
+ *
+ *   flash [-d /dev/hidrawN] [-a] [-n] [-s] [-v] image.hex
+ *
+ * The keyboard has to be in the bootloader mode, e.g., plugged in with the
+ * Esc key held down. Pages the image leaves blank are kept as they are,
+ * since they may hold the settings of the keyboard; -a erases them, too.
+ * -n only lists the pages that differ, -s stays in the bootloader after
+ * the update instead of starting the application, and -v lists the pages
+ * as they are written. The configuration words and the EEPROM are never
+ * written.
+ *
+ * The application is made unbootable before the first page is written by
+ * rewriting the page of the flash signature without it, and the signature
+ * is written back (SIGN_FLASH) only after every page has been verified, so
+ * an interrupted update leaves the keyboard in the bootloader.
+ *
+ * Build in firmware/:
+ *
+ *   cc -O2 -o flash tools/flash/flash.c
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <linux/hidraw.h>
+#include <sys/ioctl.h>
+
+#define BOOT_VID                0x04D8
+#define BOOT_PID                0x003C
+
+#define QUERY_DEVICE            0x02
+#define RESET_DEVICE            0x08
+#define SIGN_FLASH              0x09
+#define QUERY_EXTENDED_INFO     0x0C
+#define GET_CHECKSUMS           0x10
+#define LOAD_PAGE               0x11
+#define WRITE_PAGE              0x12
+
+#define MEMORY_REGION_PROGRAM_MEM   0x01
+#define MEMORY_REGION_END           0xFF
+#define BOOTLOADER_V1_01_OR_NEWER_FLAG  0xA5
+#define BOOTLOADER_DELTA_VERSION    0x0103  // GET_CHECKSUMS, LOAD_PAGE and WRITE_PAGE
+
+#define PACKET_SIZE             64
+#define REQUEST_DATA_BLOCK_SIZE 58
+#define CHECKSUM_MAX_BLOCKS     28
+#define REPLY_TIMEOUT           5000    // [msec]
+#define MEMORY_MAX              0x200000
+#define HIDRAW_MAX              64
+
+typedef struct {
+    uint32_t start;         // the application program memory
+    uint32_t length;
+    uint32_t pageSize;
+    uint32_t sigAddress;    // the flash signature word
+    uint16_t sigValue;
+    uint16_t version;       // of the bootloader
+} Device;
+
+static uint8_t image[MEMORY_MAX];
+static bool used[MEMORY_MAX];
+static bool verbose;
+
+static uint32_t get32(const uint8_t* p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+static void put32(uint8_t* p, uint32_t value)
+{
+    p[0] = value;
+    p[1] = value >> 8;
+    p[2] = value >> 16;
+    p[3] = value >> 24;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// The same CRC as ChecksumBlock() of the bootloaders
+static uint16_t crc16(const uint8_t* data, uint32_t length)
+{
+    uint16_t crc = 0xFFFF;
+
+    while (length--) {
+        crc = (crc >> 8) | (crc << 8);
+        crc ^= *data++;
+        crc ^= (uint8_t) crc >> 4;
+        crc ^= crc << 12;
+        crc ^= (crc & 0xFF) << 5;
+    }
+    return crc;
+}
+
+static int openDevice(const char* path)
+{
+    struct hidraw_devinfo info;
+    char name[32];
+    int fd;
+
+    for (int i = 0; i < HIDRAW_MAX; ++i) {
+        if (!path)
+            snprintf(name, sizeof name, "/dev/hidraw%d", i);
+        fd = open(path ? path : name, O_RDWR);
+        if (0 <= fd) {
+            if (ioctl(fd, HIDIOCGRAWINFO, &info) == 0 &&
+                (uint16_t) info.vendor == BOOT_VID && (uint16_t) info.product == BOOT_PID)
+                return fd;
+            close(fd);
+        }
+        if (path)
+            break;
+    }
+    if (path)
+        fprintf(stderr, "%s: not the HID bootloader\n", path);
+    else
+        fprintf(stderr, "flash: no keyboard in the bootloader mode found\n");
+    return -1;
+}
+
+static int sendPacket(int fd, const uint8_t* packet)
+{
+    uint8_t report[PACKET_SIZE + 1];
+
+    report[0] = 0;  // no report ID
+    memcpy(report + 1, packet, PACKET_SIZE);
+    if (write(fd, report, sizeof report) != sizeof report) {
+        perror("flash: write");
+        return -1;
+    }
+    return 0;
+}
+
+static int transfer(int fd, const uint8_t* packet, uint8_t* reply)
+{
+    struct pollfd pfd = { .fd = fd, .events = POLLIN };
+
+    if (sendPacket(fd, packet) < 0)
+        return -1;
+    for (;;) {
+        int n = poll(&pfd, 1, REPLY_TIMEOUT);
+        if (n <= 0) {
+            fprintf(stderr, "flash: no reply to command 0x%02x\n", packet[0]);
+            return -1;
+        }
+        n = read(fd, reply, PACKET_SIZE);
+        if (n < 0) {
+            perror("flash: read");
+            return -1;
+        }
+        if (n == PACKET_SIZE && reply[0] == packet[0])
+            return 0;
+    }
+}
+
+static int queryDevice(int fd, Device* dev)
+{
+    uint8_t packet[PACKET_SIZE] = { QUERY_DEVICE };
+    uint8_t reply[PACKET_SIZE];
+
+    if (transfer(fd, packet, reply) < 0)
+        return -1;
+    dev->length = 0;
+    for (const uint8_t* p = reply + 3; p + 9 <= reply + 57 && *p != MEMORY_REGION_END; p += 9) {
+        if (*p == MEMORY_REGION_PROGRAM_MEM) {
+            dev->start = get32(p + 1);
+            dev->length = get32(p + 5);
+            break;
+        }
+    }
+    if (reply[57] != BOOTLOADER_V1_01_OR_NEWER_FLAG || dev->length == 0) {
+        fprintf(stderr, "flash: the bootloader is too old\n");
+        return -1;
+    }
+
+    memset(packet, 0, sizeof packet);
+    packet[0] = QUERY_EXTENDED_INFO;
+    if (transfer(fd, packet, reply) < 0)
+        return -1;
+    dev->version = reply[1] | (reply[2] << 8);
+    dev->sigAddress = get32(reply + 5);
+    dev->sigValue = reply[9] | (reply[10] << 8);
+    dev->pageSize = get32(reply + 11);
+    if (dev->version < BOOTLOADER_DELTA_VERSION) {
+        fprintf(stderr, "flash: bootloader %u.%02u cannot checksum pages; 1.%02u or later is required\n",
+                dev->version >> 8, dev->version & 0xff, BOOTLOADER_DELTA_VERSION & 0xff);
+        return -1;
+    }
+    if (dev->pageSize == 0 || dev->pageSize > 0xffff || dev->start % dev->pageSize ||
+        dev->length % dev->pageSize || MEMORY_MAX < dev->start + dev->length) {
+        fprintf(stderr, "flash: unexpected memory layout\n");
+        return -1;
+    }
+    return 0;
+}
+
+static int hexByte(const char* s)
+{
+    int value;
+
+    if (sscanf(s, "%2x", &value) != 1)
+        return -1;
+    return value;
+}
+
+// Read an Intel HEX file into image[], marking the bytes it defines in used[].
+static int loadHex(const char* path)
+{
+    FILE* file = fopen(path, "r");
+    uint32_t base = 0;
+    char line[600];
+    int lineno = 0;
+
+    if (!file) {
+        perror(path);
+        return -1;
+    }
+    memset(image, 0xFF, sizeof image);
+    while (fgets(line, sizeof line, file)) {
+        uint8_t record[256 + 5];
+        uint8_t sum = 0;
+        int len;
+
+        ++lineno;
+        if (line[0] != ':')
+            continue;
+        len = hexByte(line + 1);
+        if (len < 0 || strlen(line) < 11u + len * 2)
+            goto bad;
+        for (int i = 0; i < len + 5; ++i) {
+            int b = hexByte(line + 1 + i * 2);
+            if (b < 0)
+                goto bad;
+            record[i] = b;
+            sum += b;
+        }
+        if (sum)
+            goto bad;
+
+        uint32_t offset = (record[1] << 8) | record[2];
+        switch (record[3]) {
+        case 0x00:  // data
+            for (int i = 0; i < len; ++i) {
+                uint32_t address = base + offset + i;
+                if (address < MEMORY_MAX) {
+                    image[address] = record[4 + i];
+                    used[address] = true;
+                }
+            }
+            break;
+        case 0x01:  // end of file
+            fclose(file);
+            return 0;
+        case 0x02:  // extended segment address
+            base = ((record[4] << 8) | record[5]) << 4;
+            break;
+        case 0x04:  // extended linear address
+            base = (uint32_t) ((record[4] << 8) | record[5]) << 16;
+            break;
+        default:
+            break;
+        }
+    }
+    fclose(file);
+    fprintf(stderr, "%s: no end of file record\n", path);
+    return -1;
+bad:
+    fclose(file);
+    fprintf(stderr, "%s:%d: bad record\n", path, lineno);
+    return -1;
+}
+
+// Read the checksums of count pages from the first one.
+static int getChecksums(int fd, const Device* dev, uint32_t first, uint32_t count, uint16_t* sums)
+{
+    uint8_t packet[PACKET_SIZE];
+    uint8_t reply[PACKET_SIZE];
+
+    while (count) {
+        uint32_t n = (count < CHECKSUM_MAX_BLOCKS) ? count : CHECKSUM_MAX_BLOCKS;
+
+        memset(packet, 0, sizeof packet);
+        packet[0] = GET_CHECKSUMS;
+        put32(packet + 1, dev->start + first * dev->pageSize);
+        packet[5] = n;
+        packet[6] = dev->pageSize;
+        packet[7] = dev->pageSize >> 8;
+        if (transfer(fd, packet, reply) < 0)
+            return -1;
+        if (get32(reply + 1) != get32(packet + 1) || reply[5] != n) {
+            fprintf(stderr, "flash: bad checksum reply\n");
+            return -1;
+        }
+        for (uint32_t i = 0; i < n; ++i)
+            sums[i] = reply[8 + i * 2] | (reply[9 + i * 2] << 8);
+        first += n;
+        count -= n;
+        sums += n;
+    }
+    return 0;
+}
+
+// Load the page into the page buffer of the bootloader and write it.
+static int writePage(int fd, const Device* dev, const uint8_t* data, uint32_t address)
+{
+    uint8_t packet[PACKET_SIZE];
+
+    for (uint32_t offset = 0; offset < dev->pageSize; offset += REQUEST_DATA_BLOCK_SIZE) {
+        uint32_t n = dev->pageSize - offset;
+        bool blank = true;
+
+        if (REQUEST_DATA_BLOCK_SIZE < n)
+            n = REQUEST_DATA_BLOCK_SIZE;
+        for (uint32_t i = 0; i < n; ++i)
+            blank &= data[offset + i] == 0xFF;
+        // The buffer starts out blank; the first packet selects the page.
+        if (blank && offset)
+            continue;
+        memset(packet, 0, sizeof packet);
+        packet[0] = LOAD_PAGE;
+        put32(packet + 1, address + offset);
+        packet[5] = n;
+        memcpy(packet + 6 + REQUEST_DATA_BLOCK_SIZE - n, data + offset, n);  // right justified
+        if (sendPacket(fd, packet) < 0)
+            return -1;
+    }
+    memset(packet, 0, sizeof packet);
+    packet[0] = WRITE_PAGE;
+    put32(packet + 1, address);
+    return sendPacket(fd, packet);
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "usage: flash [-d /dev/hidrawN] [-a] [-n] [-s] [-v] image.hex\n");
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char* argv[])
+{
+    const char* device = NULL;
+    bool all = false;
+    bool dryRun = false;
+    bool stay = false;
+    uint8_t packet[PACKET_SIZE];
+    uint8_t page[0x10000];
+    uint32_t pages, sigPage, differ, written;
+    uint16_t *expected, *actual;
+    bool *selected, *dirty;
+    Device dev;
+    double start;
+    int opt;
+    int fd;
+
+    while ((opt = getopt(argc, argv, "d:ansv")) != -1) {
+        switch (opt) {
+        case 'd':
+            device = optarg;
+            break;
+        case 'a':
+            all = true;
+            break;
+        case 'n':
+            dryRun = true;
+            break;
+        case 's':
+            stay = true;
+            break;
+        case 'v':
+            verbose = true;
+            break;
+        default:
+            usage();
+        }
+    }
+    if (optind + 1 != argc)
+        usage();
+
+    if (loadHex(argv[optind]) < 0)
+        return EXIT_FAILURE;
+    fd = openDevice(device);
+    if (fd < 0)
+        return EXIT_FAILURE;
+    start = now();
+    if (queryDevice(fd, &dev) < 0)
+        return EXIT_FAILURE;
+
+    pages = dev.length / dev.pageSize;
+    sigPage = (dev.sigAddress - dev.start) / dev.pageSize;
+    expected = calloc(pages, sizeof *expected);
+    actual = calloc(pages, sizeof *actual);
+    selected = calloc(pages, sizeof *selected);
+    dirty = calloc(pages, sizeof *dirty);
+    if (!expected || !actual || !selected || !dirty) {
+        perror("flash");
+        return EXIT_FAILURE;
+    }
+
+    // The image as it should read after SIGN_FLASH
+    if (sigPage < pages) {
+        image[dev.sigAddress] = dev.sigValue;
+        image[dev.sigAddress + 1] = dev.sigValue >> 8;
+        used[dev.sigAddress] = used[dev.sigAddress + 1] = true;
+    }
+    for (uint32_t p = 0; p < pages; ++p) {
+        uint32_t address = dev.start + p * dev.pageSize;
+        expected[p] = crc16(image + address, dev.pageSize);
+        selected[p] = all;
+        for (uint32_t i = 0; !selected[p] && i < dev.pageSize; ++i)
+            selected[p] = used[address + i];
+    }
+
+    // Compare the selected pages in runs of consecutive pages.
+    differ = 0;
+    for (uint32_t p = 0; p < pages; ) {
+        uint32_t n = 0;
+        if (!selected[p]) {
+            ++p;
+            continue;
+        }
+        while (p + n < pages && selected[p + n])
+            ++n;
+        if (getChecksums(fd, &dev, p, n, actual + p) < 0)
+            return EXIT_FAILURE;
+        for (uint32_t i = p; i < p + n; ++i) {
+            if (actual[i] != expected[i]) {
+                ++differ;
+                if (dryRun || verbose)
+                    printf("0x%06x: %04x -> %04x\n", dev.start + i * dev.pageSize, actual[i], expected[i]);
+            }
+        }
+        p += n;
+    }
+    printf("bootloader %u.%02u: %u of %u pages differ\n", dev.version >> 8, dev.version & 0xff, differ, pages);
+    if (dryRun)
+        return EXIT_SUCCESS;
+
+    written = 0;
+    if (differ) {
+        // Make the application unbootable first: write the page of the
+        // signature without it, and the other pages after that.
+        for (uint32_t k = 0; k <= pages; ++k) {
+            uint32_t p = (k == 0) ? sigPage : k - 1;
+            uint32_t address;
+
+            if (pages <= p || (k && p == sigPage))
+                continue;
+            if (p != sigPage && (!selected[p] || actual[p] == expected[p]))
+                continue;
+            address = dev.start + p * dev.pageSize;
+            memcpy(page, image + address, dev.pageSize);
+            if (p == sigPage) {
+                page[dev.sigAddress - address] = 0xFF;
+                page[dev.sigAddress - address + 1] = 0xFF;
+                expected[p] = crc16(page, dev.pageSize);
+            }
+            if (verbose)
+                printf("writing 0x%06x\n", address);
+            if (writePage(fd, &dev, page, address) < 0)
+                return EXIT_FAILURE;
+            dirty[p] = true;
+            ++written;
+        }
+
+        // Verify every page written before signing the application.
+        for (uint32_t p = 0; p < pages; ++p) {
+            if (!dirty[p])
+                continue;
+            if (getChecksums(fd, &dev, p, 1, actual + p) < 0)
+                return EXIT_FAILURE;
+            if (actual[p] != expected[p]) {
+                fprintf(stderr, "flash: verify failed at 0x%06x; the application stays unsigned\n",
+                        dev.start + p * dev.pageSize);
+                return EXIT_FAILURE;
+            }
+        }
+        if (sigPage < pages) {
+            memset(packet, 0, sizeof packet);
+            packet[0] = SIGN_FLASH;
+            if (sendPacket(fd, packet) < 0 || getChecksums(fd, &dev, sigPage, 1, actual + sigPage) < 0)
+                return EXIT_FAILURE;
+            if (actual[sigPage] != crc16(image + dev.start + sigPage * dev.pageSize, dev.pageSize)) {
+                fprintf(stderr, "flash: signing failed\n");
+                return EXIT_FAILURE;
+            }
+        }
+    }
+    printf("%u pages written in %.2f sec\n", written, now() - start);
+
+    if (!stay) {
+        memset(packet, 0, sizeof packet);
+        packet[0] = RESET_DEVICE;
+        sendPacket(fd, packet);   // the bootloader detaches at once
+    }
+    close(fd);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,747 @@
+/*
+ * Copyright 2026 Esrille Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/*
+ * hossim - simulator of the nRF51 HOS module for HosMaster.c
+ *
+ * Runs HosMainLoop() on Linux against a model of the BLE module firmware
+ * so that changes to the HOS link can be measured without hardware. The
+ * model follows the module state machine (off, idle, advertising, bonding,
+ * connected, suspended), answers HOS_DEF_CHARACTER while it is busy, and
+ * sends queued reports to the host at each connection event. HosMaster.c
+ * is built with HOS_SPI_HOOK so that HosSpiSelect() and HosXfer() below
+ * take the place of the SPI2 peripheral.
+ *
+ * Build in firmware/:
+ *
+ *   cc -O2 -DWITH_HOS -DHOS_SPI_HOOK -Itools/hossim/include -Isrc \
+ *      -Ithird_party/mla_v2013_12_20/bsp/pic18f47j53_nisse \
+ *      -o hossim tools/hossim/hossim.c src/HosMaster.c
+ *
+ * With -V, the battery voltage reported by the module follows a trace
+ * file of "<sec> <volts>" lines, and the changes of the power policy are
+ * printed as HosMainLoop() makes them.
+ *
+ * ENABLE_MOUSE is not supported.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <system.h>
+#include <spi.h>
+#include <timers.h>
+#include <app_led_usb_status.h>
+#include <app_device_keyboard.h>
+#include <Keyboard.h>
+
+#define TICK_NSEC       (1000000000ull / WDT_FREQ)
+#define REPORT_SIZE     8
+#define QUEUE_MAX       32
+#define LATENCY_MAX     65535
+#define SEQ_NONE        0xffff  // reports not generated by the typing model
+#define REPLY_SIZE      (HOS_STATE_LAST + 1)
+#define RX_MAX          32
+#define MODULE_BOOTING  0xff    // internal state while the module boots
+#define BATT_DEFAULT    (300 - HOS_BATTERY_VOLTAGE_OFFSET)  // 3.00 V
+#define TRACE_MAX       256
+
+#define MSEC(x)         ((uint64_t) ((x) * 1000000.0))
+#define SEC(x)          ((uint64_t) ((x) * 1000000000.0))
+
+typedef struct Options {
+    double duration;        // [sec]
+    double rate;            // keyboard reports per second
+    double interval;        // connection interval [msec]
+    int perEvent;           // reports sent per connection event
+    int depth;              // module report queue depth
+    int busy;               // probability of busy replies [%]
+    double guard;           // minimum CS guard time [usec]
+    double sck;             // maximum SCK [kHz]
+    double boot;            // module boot time [msec]
+    double connect;         // reconnection time [msec]
+    double bond;            // bonding time [msec]
+    double wake;            // host wake up time [msec]
+    double dropAt, dropFor; // link loss [sec], [msec]
+    double suspendAt;       // host suspend [sec]
+    double switchAt;        // profile switch [sec]
+    double scan;            // key matrix scan time [usec]
+    bool warm;              // start connected
+    bool unbonded;          // bond before connecting
+} Options;
+
+static Options opt = {
+    .duration = 10.0,
+    .rate = 10.0,
+    .interval = 15.0,
+    .perEvent = 2,
+    .depth = 6,
+    .busy = 0,
+    .guard = 7.1,
+    .sck = 2000.0,
+    .boot = 300.0,
+    .connect = 100.0,
+    .bond = 2000.0,
+    .wake = 50.0,
+    .dropAt = -1.0,
+    .suspendAt = -1.0,
+    .switchAt = -1.0,
+    .scan = 500.0,
+};
+
+typedef struct Module {
+    uint8_t state;
+    uint8_t next;               // state after transition
+    uint64_t transition;        // 0 if none
+    bool suspended;
+    uint64_t resume;            // time the host wakes up; 0 if none
+    uint8_t profile;
+    bool bonded;
+    uint8_t type;               // type of the last command
+    uint8_t led;
+    uint8_t batt;
+    uint64_t event;             // next connection event
+
+    uint8_t queue[QUEUE_MAX][REPORT_SIZE];
+    int head;
+    int count;
+
+    // current transaction
+    bool busy;
+    bool garbled;
+    uint64_t selected;
+    uint8_t reply[REPLY_SIZE];
+    uint8_t rx[RX_MAX];
+    int pos;
+} Module;
+
+typedef struct Counters {
+    unsigned transactions;
+    unsigned busy;
+    unsigned garbled;
+    unsigned rejected;          // reports received while not connected
+    unsigned flushed;           // reports lost on link loss or profile switch
+    unsigned generated;
+    unsigned delivered;
+    unsigned scans;
+    uint64_t awake;
+    uint64_t sleeping;
+    uint64_t suspended;
+} Counters;
+
+static Module module;
+static Counters counters;
+
+static uint64_t now;            // [nsec]
+static uint64_t sleepStart;
+static bool inSuspend;
+static double sckHz;
+
+static uint8_t currentProfile = 1;
+static uint8_t common[NVRAM_COMMON_SIZE];
+
+static uint64_t generatedAt[LATENCY_MAX];
+static uint64_t latency[LATENCY_MAX];
+static unsigned nextKey;
+static bool dropped;
+static bool switched;
+static bool suspendedHost;
+
+static double traceAt[TRACE_MAX];   // [sec]
+static double traceVolts[TRACE_MAX];
+static int traceCount;
+static const HosPolicy* lastPolicy;
+
+static void Report(void);
+
+//
+// nRF51 module model
+//
+
+static void Enter(uint8_t state, double delay, uint8_t next)
+{
+    module.state = state;
+    module.next = next;
+    module.transition = delay < 0 ? 0 : now + MSEC(delay);
+    if (state == HOS_BLE_STATE_CONNECTED)
+        module.event = now + MSEC(opt.interval);
+}
+
+static void Reconnect(double delay)
+{
+    counters.flushed += module.count;
+    module.head = module.count = 0;
+    if (module.bonded)
+        Enter(HOS_BLE_STATE_ADVERTISING_DIRECTED, delay, HOS_BLE_STATE_CONNECTED);
+    else
+        Enter(HOS_BLE_STATE_ADVERTISING, delay, HOS_BLE_STATE_BONDING);
+}
+
+static void Deliver(uint64_t at)
+{
+    for (int i = 0; i < opt.perEvent && module.count; ++i) {
+        uint8_t* report = module.queue[module.head];
+        unsigned seq = report[6] | (report[7] << 8);
+        if (seq != SEQ_NONE) {
+            if (counters.delivered < LATENCY_MAX)
+                latency[counters.delivered] = at - generatedAt[seq];
+            ++counters.delivered;
+        }
+        module.head = (module.head + 1) % QUEUE_MAX;
+        --module.count;
+    }
+}
+
+static void Advance(void)
+{
+    for (;;) {
+        uint64_t next = UINT64_MAX;
+
+        if (module.transition)
+            next = module.transition;
+        if (module.state == HOS_BLE_STATE_CONNECTED && module.event < next)
+            next = module.event;
+        if (module.resume && module.resume < next)
+            next = module.resume;
+        if (now < next)
+            break;
+
+        if (next == module.resume) {
+            module.resume = 0;
+            module.suspended = false;
+        } else if (next == module.transition) {
+            uint8_t state = module.next;
+            module.transition = 0;
+            if (state == HOS_BLE_STATE_BONDING) {
+                Enter(HOS_BLE_STATE_BONDING, opt.bond, HOS_BLE_STATE_CONNECTED);
+                module.bonded = true;
+            } else if (state == HOS_BLE_STATE_ADVERTISING_DIRECTED) {
+                Reconnect(opt.connect);
+            } else {
+                Enter(state, -1, state);
+            }
+        } else {
+            if (!module.suspended)
+                Deliver(module.event);
+            module.event += MSEC(opt.interval);
+        }
+    }
+
+    // Scenario
+    if (traceCount) {
+        double t = now / 1e9;
+        double v = traceVolts[traceCount - 1];
+        for (int i = 1; i < traceCount; ++i) {
+            if (t < traceAt[i]) {
+                double r = (t - traceAt[i - 1]) / (traceAt[i] - traceAt[i - 1]);
+                v = traceVolts[i - 1] + r * (traceVolts[i] - traceVolts[i - 1]);
+                break;
+            }
+        }
+        if (t < traceAt[0])
+            v = traceVolts[0];
+        int batt = (int) (v * 100.0 + 0.5) - HOS_BATTERY_VOLTAGE_OFFSET;
+        module.batt = (batt < 0) ? 0 : (255 < batt) ? 255 : batt;
+    }
+    if (0 <= opt.dropAt && !dropped && SEC(opt.dropAt) <= now) {
+        dropped = true;
+        if (module.state == HOS_BLE_STATE_CONNECTED)
+            Reconnect(opt.dropFor);
+    }
+    if (0 <= opt.suspendAt && !suspendedHost && SEC(opt.suspendAt) <= now) {
+        suspendedHost = true;
+        if (module.state == HOS_BLE_STATE_CONNECTED)
+            module.suspended = true;
+    }
+}
+
+static void Prepare(void)
+{
+    uint8_t p = module.profile;
+
+    memset(module.reply, HOS_DEF_CHARACTER, REPLY_SIZE);
+    if (module.busy)
+        return;
+    module.reply[HOS_STATE_PROFILE] = ((~p << 4) & 0xf0) | p;
+    module.reply[HOS_STATE_LED] = module.led;
+    module.reply[HOS_STATE_BATT] = module.batt;
+    module.reply[HOS_STATE_INDICATE] = module.state | (module.suspended ? HOS_BLE_STATE_SUSPENDED : 0);
+    module.reply[HOS_STATE_TYPE] = module.type;
+    if (module.type == HOS_TYPE_INFO) {
+        module.reply[HOS_STATE_REV_MAJOR] = 0;
+        module.reply[HOS_STATE_REV_MINOR] = 2;
+        module.reply[HOS_STATE_VER_MAJOR] = 0;
+        module.reply[HOS_STATE_VER_MINOR] = 0x15;
+    } else {
+        memset(module.reply + HOS_STATE_COMMON_LAST + 1, 0, REPLY_SIZE - HOS_STATE_COMMON_LAST - 1);
+    }
+}
+
+static void Process(void)
+{
+    uint8_t type = module.rx[0];
+    uint8_t cmd = module.rx[1];
+    uint8_t len = module.rx[2];
+    const uint8_t* data = module.rx + 3;
+
+    if (module.pos < 3 || module.pos < 3 + len)
+        return;
+    module.type = type;
+    switch (cmd) {
+    case HOS_CMD_SET_EVENT:
+        if (data[0] == HOS_EVENT_SLEEP) {
+            counters.flushed += module.count;
+            module.head = module.count = 0;
+            Enter(HOS_BLE_STATE_IDLE, -1, HOS_BLE_STATE_IDLE);
+        } else if (HOS_EVENT_KEY_0 <= data[0] && data[0] <= HOS_EVENT_KEY_LAST) {
+            uint8_t profile = data[0] - HOS_EVENT_KEY_0;
+            if (profile != module.profile) {
+                module.profile = profile;
+                module.suspended = false;
+                Reconnect(opt.connect);
+            }
+        }
+        break;
+    case HOS_CMD_BATT_REPORT:
+        break;
+    case HOS_CMD_KEYBOARD_REPORT:
+    case HOS_CMD_MOUSE_REPORT:
+        if (module.state != HOS_BLE_STATE_CONNECTED || QUEUE_MAX <= module.count) {
+            ++counters.rejected;
+            break;
+        }
+        if (cmd == HOS_CMD_KEYBOARD_REPORT) {
+            memcpy(module.queue[(module.head + module.count) % QUEUE_MAX], data, REPORT_SIZE);
+            ++module.count;
+        }
+        if (module.suspended && !module.resume)
+            module.resume = now + MSEC(opt.wake);   // remote wakeup
+        break;
+    default:
+        break;
+    }
+}
+
+void HosSpiSelect(uint8_t cs)
+{
+    if (cs == 0) {
+        Advance();
+        module.selected = now;
+        module.pos = 0;
+        module.garbled = false;
+        if (module.state == HOS_BLE_STATE_IDLE) {
+            // CS wakes up the module from System OFF, which takes a reboot.
+            Enter(MODULE_BOOTING, opt.boot, HOS_BLE_STATE_ADVERTISING_DIRECTED);
+        }
+        module.busy = module.state == MODULE_BOOTING ||
+                      opt.depth <= module.count ||
+                      (opt.busy && rand() % 100 < opt.busy);
+        Prepare();
+        return;
+    }
+
+    ++counters.transactions;
+    if (module.busy)
+        ++counters.busy;
+    else if (module.garbled)
+        ++counters.garbled;
+    else
+        Process();
+}
+
+uint8_t HosXfer(uint8_t byte)
+{
+    uint8_t out = HOS_DEF_CHARACTER;
+
+    if (module.pos == 0) {
+        if (now - module.selected < (uint64_t) (opt.guard * 1000.0) || opt.sck * 1000.0 < sckHz)
+            module.garbled = true;
+    }
+    now += (uint64_t) (8e9 / sckHz) + 500;  // plus WriteSPI2() overhead
+    if (module.pos < REPLY_SIZE) {
+        out = module.reply[module.pos];
+        if (module.garbled && !module.busy && module.pos == HOS_STATE_PROFILE)
+            out ^= 0x01;
+    }
+    if (module.pos < RX_MAX)
+        module.rx[module.pos++] = byte;
+    return out;
+}
+
+//
+// Stand-ins for the PIC18F47J53 and the rest of the firmware
+//
+
+struct SimBits simBits;
+uint8_t PMDIS0, PMDIS1, PMDIS2, PMDIS3;
+uint8_t T2CON, PR2, SSP2BUF;
+
+static void CheckEnd(void)
+{
+    if (SEC(opt.duration) <= now) {
+        Report();
+        exit(EXIT_SUCCESS);
+    }
+}
+
+void SimDelayUs(uint32_t usec)
+{
+    now += usec * 1000ull;
+    CheckEnd();
+}
+
+void SimSleep(void)
+{
+    counters.awake += now - sleepStart;
+    now += TICK_NSEC;
+    if (inSuspend)
+        counters.suspended += TICK_NSEC;
+    else
+        counters.sleeping += TICK_NSEC;
+    sleepStart = now;
+    Advance();
+    if (traceCount && HosGetPolicy() != lastPolicy) {
+        const HosPolicy* p = HosGetPolicy();
+        lastPolicy = p;
+        printf("%8.1f s: battery %u.%02u V %u%%, policy <= %u%%: scan %u, poll %u, led %u, adv %u s\n",
+               now / 1e9, HosGetBatteryVoltage() / 100, HosGetBatteryVoltage() % 100,
+               HosGetBatteryLevel(), p->level, p->scan, p->poll, p->led, p->advTimeout / WDT_FREQ);
+    }
+    CheckEnd();
+}
+
+void SimReset(void)
+{
+    printf("hossim: reset requested by the firmware\n");
+    Report();
+    exit(EXIT_FAILURE);
+}
+
+void OpenSPI2(uint8_t sync_mode, uint8_t bus_mode, uint8_t smp_phase)
+{
+    (void) bus_mode;
+    (void) smp_phase;
+    switch (sync_mode) {
+    case SPI_FOSC_4:
+        sckHz = _XTAL_FREQ / 4.0;
+        break;
+    case SPI_FOSC_16:
+        sckHz = _XTAL_FREQ / 16.0;
+        break;
+    case SPI_FOSC_TMR2:
+        sckHz = _XTAL_FREQ / 4.0 / (PR2 + 1) / 2;
+        break;
+    default:
+        sckHz = _XTAL_FREQ / 64.0;
+        break;
+    }
+}
+
+void CloseSPI2(void)
+{
+}
+
+void OpenTimer0(unsigned char config)
+{
+    (void) config;
+}
+
+unsigned int ReadTimer0(void)
+{
+    return (unsigned int) (now * (_XTAL_FREQ / 4 / 256) / 1000000000ull) & 0xffff;
+}
+
+void ReadNvramCommon(uint8_t offset, void* data, uint8_t len)
+{
+    memcpy(data, common + offset, len);
+}
+
+void WriteNvramCommon(uint8_t offset, const void* data, uint8_t len)
+{
+    memcpy(common + offset, data, len);
+}
+
+uint8_t CurrentProfile(void)
+{
+    return currentProfile;
+}
+
+void SyncNvram(void)
+{
+}
+
+uint8_t isBusPowered(void)
+{
+    return 0;
+}
+
+int8_t isUSBMode(void)
+{
+    return CurrentProfile() == 0;
+}
+
+void LED_On(LED led)
+{
+    (void) led;
+}
+
+void LED_Off(LED led)
+{
+    (void) led;
+}
+
+bool LED_Get(LED led)
+{
+    (void) led;
+    return false;
+}
+
+void LED_SetLevel(LED led, uint8_t level)
+{
+    (void) led;
+    (void) level;
+}
+
+void LED_SetPattern(LED led, const LED_PATTERN* pattern)
+{
+    (void) led;
+    (void) pattern;
+}
+
+void LED_Tick(void)
+{
+}
+
+bool LED_Pulse(uint16_t elapsed, uint16_t period)
+{
+    (void) elapsed;
+    (void) period;
+    return false;
+}
+
+void APP_LEDUpdate(uint8_t report)
+{
+    (void) report;
+}
+
+uint8_t controlLED(uint8_t report)
+{
+    return report;
+}
+
+void APP_Suspend(void)
+{
+    inSuspend = true;
+}
+
+void APP_WakeFromSuspend(void)
+{
+    inSuspend = false;
+}
+
+static uint64_t NextKeyAt(void)
+{
+    return (uint64_t) (nextKey * 1e9 / opt.rate);
+}
+
+bool BUTTON_IsPressed(void)
+{
+    return NextKeyAt() <= now;
+}
+
+void BUTTON_EnableWakeUp(void)
+{
+}
+
+void BUTTON_DisableWakeUp(void)
+{
+}
+
+void BUTTON_ClearWakeUpFlags(void)
+{
+}
+
+// Types press and release reports alternately at opt.rate. The sequence
+// number is kept in the last two key slots to measure the latency.
+uint8_t* APP_KeyboardScan(void)
+{
+    static uint8_t report[REPORT_SIZE];
+
+    now += (uint64_t) (opt.scan * 1000.0);
+    ++counters.scans;
+    if (0 <= opt.switchAt && !switched && SEC(opt.switchAt) <= now) {
+        // Fn + F2 with the HOS switch: break to the previous host
+        switched = true;
+        currentProfile = (currentProfile == 1) ? 2 : 1;
+        memset(report, 0, REPORT_SIZE);
+        report[6] = report[7] = SEQ_NONE & 0xff;
+        return report;
+    }
+    if (now < NextKeyAt() || LATENCY_MAX <= nextKey)
+        return NULL;
+    memset(report, 0, REPORT_SIZE);
+    if (!(nextKey & 1))
+        report[2] = KEY_A + (nextKey / 2) % 26;
+    report[6] = nextKey & 0xff;
+    report[7] = nextKey >> 8;
+    generatedAt[nextKey++] = now;
+    ++counters.generated;
+    return report;
+}
+
+//
+// Main
+//
+
+static int Compare(const void* a, const void* b)
+{
+    uint64_t x = *(const uint64_t*) a;
+    uint64_t y = *(const uint64_t*) b;
+    return (x > y) - (x < y);
+}
+
+static void Report(void)
+{
+    unsigned n = counters.delivered < LATENCY_MAX ? counters.delivered : LATENCY_MAX;
+    const HosStats* stats = HosGetStats();
+    double total = (double) now;
+
+    printf("simulated: %.1f s, connection interval %.1f ms, %d reports/event\n",
+           now / 1e9, opt.interval, opt.perEvent);
+    printf("reports: generated %u, delivered %u, rejected %u, flushed %u\n",
+           counters.generated, counters.delivered, counters.rejected, counters.flushed);
+    printf("throughput: %.1f reports/s\n", counters.delivered / (now / 1e9));
+    if (n) {
+        uint64_t sum = 0;
+        qsort(latency, n, sizeof latency[0], Compare);
+        for (unsigned i = 0; i < n; ++i)
+            sum += latency[i];
+        printf("latency: min %.1f, avg %.1f, p50 %.1f, p95 %.1f, max %.1f ms\n",
+               latency[0] / 1e6, sum / (double) n / 1e6,
+               latency[n / 2] / 1e6, latency[n * 95 / 100] / 1e6, latency[n - 1] / 1e6);
+    }
+    printf("module: transactions %u, busy %u, garbled %u, SCK %.0f kHz\n",
+           counters.transactions, counters.busy, counters.garbled, sckHz / 1000);
+    printf("firmware: xfers");
+    for (unsigned i = 0; i < sizeof stats->xfers / sizeof stats->xfers[0]; ++i)
+        printf(" %u", stats->xfers[i]);
+    printf(", retries %u, bad %u, failures %u, worst %u us, startup %u ms\n",
+           stats->retries, stats->bad, stats->failures, stats->worst, HosGetStartupTime());
+    printf("scans: %u (%.1f/s)\n", counters.scans, counters.scans / (now / 1e9));
+    printf("time: awake %.1f%%, sleeping %.1f%%, suspended %.1f%%\n",
+           100 * counters.awake / total, 100 * counters.sleeping / total, 100 * counters.suspended / total);
+}
+
+static void ParsePair(const char* arg, double* a, double* b)
+{
+    if (sscanf(arg, "%lf,%lf", a, b) != 2) {
+        fprintf(stderr, "hossim: expected <sec>,<msec>: %s\n", arg);
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void LoadTrace(const char* path)
+{
+    FILE* file = fopen(path, "r");
+    char line[128];
+
+    if (!file) {
+        perror(path);
+        exit(EXIT_FAILURE);
+    }
+    while (fgets(line, sizeof line, file) && traceCount < TRACE_MAX) {
+        if (line[0] == '#')
+            continue;
+        if (sscanf(line, "%lf %lf", &traceAt[traceCount], &traceVolts[traceCount]) == 2)
+            ++traceCount;
+    }
+    fclose(file);
+    if (!traceCount) {
+        fprintf(stderr, "hossim: no samples in %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void Usage(void)
+{
+    fprintf(stderr,
+            "usage: hossim [options]\n"
+            "  -t sec       simulated time (%.0f)\n"
+            "  -r n         keyboard reports per second (%.0f)\n"
+            "  -i msec      connection interval (%.1f)\n"
+            "  -n n         reports sent per connection event (%d)\n"
+            "  -q n         module report queue depth (%d)\n"
+            "  -b percent   busy replies (%d)\n"
+            "  -g usec      minimum CS guard time (%.1f)\n"
+            "  -k kHz       maximum SCK (%.0f)\n"
+            "  -c msec      reconnection time (%.0f)\n"
+            "  -d sec,msec  drop the link at sec for msec\n"
+            "  -s sec       suspend the host at sec\n"
+            "  -p sec       switch the profile at sec\n"
+            "  -u           start unbonded\n"
+            "  -w           start connected instead of powering up\n"
+            "  -V file      battery voltage trace of <sec> <volts> lines\n"
+            "  -R seed      random seed\n",
+            opt.duration, opt.rate, opt.interval, opt.perEvent, opt.depth,
+            opt.busy, opt.guard, opt.sck, opt.connect);
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char* argv[])
+{
+    int c;
+
+    while ((c = getopt(argc, argv, "t:r:i:n:q:b:g:k:c:d:s:p:uwR:V:h")) != -1) {
+        switch (c) {
+        case 't': opt.duration = atof(optarg); break;
+        case 'r': opt.rate = atof(optarg); break;
+        case 'i': opt.interval = atof(optarg); break;
+        case 'n': opt.perEvent = atoi(optarg); break;
+        case 'q': opt.depth = atoi(optarg); break;
+        case 'b': opt.busy = atoi(optarg); break;
+        case 'g': opt.guard = atof(optarg); break;
+        case 'k': opt.sck = atof(optarg); break;
+        case 'c': opt.connect = atof(optarg); break;
+        case 'd': ParsePair(optarg, &opt.dropAt, &opt.dropFor); break;
+        case 's': opt.suspendAt = atof(optarg); break;
+        case 'p': opt.switchAt = atof(optarg); break;
+        case 'u': opt.unbonded = true; break;
+        case 'w': opt.warm = true; break;
+        case 'R': srand(atoi(optarg)); break;
+        case 'V': LoadTrace(optarg); break;
+        default: Usage(); break;
+        }
+    }
+    if (opt.rate <= 0 || opt.interval <= 0 || opt.perEvent <= 0 || opt.depth <= 0 || QUEUE_MAX < opt.depth)
+        Usage();
+
+    module.profile = currentProfile;
+    module.bonded = !opt.unbonded;
+    module.batt = BATT_DEFAULT;
+    module.type = HOS_TYPE_INFO;
+    if (opt.warm)
+        Enter(HOS_BLE_STATE_CONNECTED, -1, HOS_BLE_STATE_CONNECTED);
+    else
+        Enter(MODULE_BOOTING, opt.boot, module.bonded ? HOS_BLE_STATE_ADVERTISING_DIRECTED : HOS_BLE_STATE_ADVERTISING);
+    sckHz = _XTAL_FREQ / 64.0;
+
+    HosInitialize();
+    HosMainLoop();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,26 @@
+/*
+ * Copyright 2026 Esrille Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HOSSIM_APP_DEVICE_KEYBOARD_H
+#define HOSSIM_APP_DEVICE_KEYBOARD_H
+
+#include <stdint.h>
+
+uint8_t* APP_KeyboardScan(void);
+void APP_Suspend(void);
+void APP_WakeFromSuspend(void);
+
+#endif // HOSSIM_APP_DEVICE_KEYBOARD_H
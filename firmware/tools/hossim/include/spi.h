@@ -0,0 +1,32 @@
+/*
+ * Copyright 2026 Esrille Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HOSSIM_SPI_H
+#define HOSSIM_SPI_H
+
+#include <stdint.h>
+
+#define SPI_FOSC_4      0x00
+#define SPI_FOSC_16     0x01
+#define SPI_FOSC_64     0x02
+#define SPI_FOSC_TMR2   0x03
+#define MODE_00         0
+#define SMPMID          0
+
+void OpenSPI2(uint8_t sync_mode, uint8_t bus_mode, uint8_t smp_phase);
+void CloseSPI2(void);
+
+#endif // HOSSIM_SPI_H
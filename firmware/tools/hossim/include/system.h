@@ -0,0 +1,47 @@
+/*
+ * Copyright 2026 Esrille Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Host stand-in of system_config/pic18f47j53_nisse/system.h for hossim.
+
+#ifndef SYSTEM_H
+#define SYSTEM_H
+
+#include <xc.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <leds.h>
+#include <nvram.h>
+#include <HosMaster.h>
+
+#define _XTAL_FREQ  48000000u
+#define WDT_FREQ    60u
+
+#ifdef ENABLE_MOUSE
+#define HOS_TYPE_DEFAULT    HOS_TYPE_TSAP
+#else
+#define HOS_TYPE_DEFAULT    HOS_TYPE_INFO
+#endif
+
+bool BUTTON_IsPressed(void);
+void BUTTON_EnableWakeUp(void);
+void BUTTON_DisableWakeUp(void);
+void BUTTON_ClearWakeUpFlags(void);
+#define BUTTON_IsDown()     BUTTON_IsPressed()
+uint8_t isBusPowered(void);
+int8_t isUSBMode(void);
+
+#endif // SYSTEM_H
@@ -0,0 +1,28 @@
+/*
+ * Copyright 2026 Esrille Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HOSSIM_TIMERS_H
+#define HOSSIM_TIMERS_H
+
+#define TIMER_INT_OFF   0xff
+#define T0_16BIT        0xff
+#define T0_SOURCE_INT   0xff
+#define T0_PS_1_256     0xff
+
+void OpenTimer0(unsigned char config);
+unsigned int ReadTimer0(void);
+
+#endif // HOSSIM_TIMERS_H
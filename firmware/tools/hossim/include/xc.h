@@ -0,0 +1,59 @@
+/*
+ * Copyright 2026 Esrille Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Host stand-in of <xc.h> for building HosMaster.c with hossim.
+
+#ifndef HOSSIM_XC_H
+#define HOSSIM_XC_H
+
+#include <stdint.h>
+
+struct SimBits {
+    unsigned LATD5 : 1;
+    unsigned TRISD5 : 1;
+    unsigned TRISD4 : 1;
+    unsigned TRISC7 : 1;
+    unsigned TRISC6 : 1;
+    unsigned REGSLP : 1;
+    unsigned SWDTEN : 1;
+    unsigned TMR2MD : 1;
+    unsigned GIE : 1;
+};
+
+extern struct SimBits simBits;
+extern uint8_t PMDIS0, PMDIS1, PMDIS2, PMDIS3;
+extern uint8_t T2CON, PR2, SSP2BUF;
+
+#define LATDbits    simBits
+#define TRISDbits   simBits
+#define TRISCbits   simBits
+#define WDTCONbits  simBits
+#define PMDIS1bits  simBits
+#define INTCONbits  simBits
+
+void SimDelayUs(uint32_t usec);
+void SimSleep(void);
+void SimReset(void);
+
+#define __delay_us(x)   SimDelayUs(x)
+#define __delay_ms(x)   SimDelayUs((x) * 1000u)
+#define _delay(x)       SimDelayUs((x) * 32u)   // at 125kHz while suspended
+#define Sleep()         SimSleep()
+#define Nop()
+#define CLRWDT()
+#define Reset()         SimReset()
+
+#endif // HOSSIM_XC_H
@@ -0,0 +1,361 @@
+/*
+ * Copyright 2026 Esrille Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/*
+ * mousebench - pointer acceleration tables for Mouse.c
+ *
+ * Mouse.c looks up the pointer acceleration curve in the tables of
+ * src/MouseCurve.h instead of computing it with 16-bit multiplications and
+ * divisions for every touch sample, and carries the fractional motion
+ * between samples instead of dithering small offsets with the sample
+ * tick. This tool keeps the original computation as the reference, with
+ * the whole counts saturating at 127 rather than wrapping around:
+ *
+ *   mousebench -g > src/MouseCurve.h
+ *
+ * regenerates the tables, and
+ *
+ *   mousebench [trace...]
+ *
+ * replays touch traces through both the reference and the tables for
+ * every resolution, with and without the aim button, checks that the
+ * outputs are identical where the curve moves by whole counts, and
+ * compares their speed. For the offsets that move by fractions, it holds
+ * each offset for a while at 1, 2 and 4 times the sample rate, checks
+ * that the distance travelled matches the reference within a count, and
+ * compares how far both stray from uniform motion. A trace is a text file
+ * of "<x> <y>" raw pad positions per line as typed by the touch sensor;
+ * without a trace, every position on the pad is used.
+ *
+ * Build in firmware/:
+ *
+ *   cc -O2 -Isrc -o mousebench tools/mousebench/mousebench.c -lm
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <Mouse.h>
+#include <MouseCurve.h>
+
+#define THRESH_XY       48      // x or y value threshold of the curves
+#define TICK_MAX        10      // tick in processSerialData() cycles 0 to TICK_MAX
+#define SAMPLES_MAX     65536
+#define ROUNDS          64
+#define HOLD            (11u * 16u) // nominal samples an offset is held
+#define SHIFT_MAX       2
+#define CURVE_SHIFT     7           // MOUSE_CURVE_SHIFT to generate
+
+static const uint8_t normalTable[PAD_SENSE_MAX + 1] = {
+    3, 4, 5, 6
+};
+static const uint8_t aimTable[PAD_SENSE_MAX + 1] = {
+    2, 2, 3, 3
+};
+
+static uint8_t samples[SAMPLES_MAX][2];
+static unsigned count;
+
+// XC8 evaluates uint16_t products in 16 bits as int is 16-bit on PIC18.
+#define MUL16(a, b)     ((uint16_t) ((a) * (b)))
+
+// The curve where it moves by whole counts, up to 128. Mouse.c before the
+// tables computed value * value in 16 bits, which wrapped past 255 so that a
+// hard swipe stopped or jerked the pointer; this saturates instead.
+static uint16_t cubic(uint16_t value)
+{
+    uint32_t cube = (uint32_t) value * value / (THRESH_XY * THRESH_XY) * value / THRESH_XY;
+
+    return (128 <= cube) ? 128 : (uint16_t) cube;
+}
+
+// trimXY() of Mouse.c before the tables, clamped at 127 by cubic()
+static int8_t trimReference(uint8_t raw, uint8_t center, uint8_t r, uint8_t tick)
+{
+    int8_t sign;
+    uint16_t value;
+
+    if (center <= raw) {
+        sign = 1;
+        value = raw - center;
+    } else {
+        sign = -1;
+        value = center - raw;
+    }
+    if (value < THRESH_XY / 2)
+        return 0;
+    value *= r;
+    value /= 3;
+    if (value < THRESH_XY) {
+        value = MUL16(MUL16(MUL16(value, value) / THRESH_XY, value) / THRESH_XY, 10) / THRESH_XY;
+        value = (tick <= value) ? 1 : 0;
+    } else {
+        value = cubic(value);
+        if (128 <= value)
+            return (0 < sign) ? 127 : -127;
+    }
+    return sign * value;
+}
+
+// trimXY() of Mouse.c with the tables; shift is PAD_SAMPLE_SHIFT.
+static int8_t trimTable(uint8_t raw, uint8_t center, const uint8_t* curve, int16_t* acc, uint8_t shift)
+{
+    uint8_t value;
+    int16_t motion;
+    int8_t out;
+
+    value = curve[(center <= raw) ? (uint8_t) (raw - center) : (uint8_t) (center - raw)];
+    if (!value) {
+        *acc = 0;
+        return 0;
+    }
+    if (value & MOUSE_CURVE_FRACTION)
+        motion = value & ~MOUSE_CURVE_FRACTION;
+    else
+        motion = (int16_t) value << MOUSE_CURVE_SHIFT;
+    if (center <= raw)
+        *acc += motion;
+    else
+        *acc -= motion;
+    if (*acc < 0)
+        out = -(int8_t) ((-*acc) >> (MOUSE_CURVE_SHIFT + shift));
+    else
+        out = *acc >> (MOUSE_CURVE_SHIFT + shift);
+    *acc -= (int16_t) out << (MOUSE_CURVE_SHIFT + shift);
+    return out;
+}
+
+// The table entry for the offset from the centre with the multiplier r
+static uint8_t entry(uint16_t value, uint8_t r)
+{
+    if (value < THRESH_XY / 2)
+        return 0;
+    value *= r;
+    value /= 3;
+    if (value < THRESH_XY) {
+        // The reference moves by one on (k + 1) of every TICK_MAX + 1 samples.
+        uint16_t k = MUL16(MUL16(MUL16(value, value) / THRESH_XY, value) / THRESH_XY, 10) / THRESH_XY;
+        return MOUSE_CURVE_FRACTION | (((k + 1) << (CURVE_SHIFT + 1)) / (TICK_MAX + 1) + 1) / 2;
+    }
+    value = cubic(value);
+    return (128 <= value) ? 127 : value;
+}
+
+static void generate(void)
+{
+    printf("/*\n"
+           " * Copyright 2026 Esrille Inc.\n"
+           " *\n"
+           " * Licensed under the Apache License, Version 2.0 (the \"License\");\n"
+           " * you may not use this file except in compliance with the License.\n"
+           " * You may obtain a copy of the License at\n"
+           " *\n"
+           " *     http://www.apache.org/licenses/LICENSE-2.0\n"
+           " *\n"
+           " * Unless required by applicable law or agreed to in writing, software\n"
+           " * distributed under the License is distributed on an \"AS IS\" BASIS,\n"
+           " * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.\n"
+           " * See the License for the specific language governing permissions and\n"
+           " * limitations under the License.\n"
+           " */\n"
+           "\n"
+           "// Generated by tools/mousebench/mousebench -g; do not edit.\n"
+           "\n"
+           "#ifndef MOUSE_CURVE_H\n"
+           "#define MOUSE_CURVE_H\n"
+           "\n"
+           "#include <stdint.h>\n"
+           "\n"
+           "// Pointer motion per sample by the offset from the centre. An entry with\n"
+           "// MOUSE_CURVE_FRACTION holds the motion in 1/(1 << MOUSE_CURVE_SHIFT)\n"
+           "// counts; otherwise the entry is the motion in counts.\n"
+           "#define MOUSE_CURVE_FRACTION    0x80\n"
+           "#define MOUSE_CURVE_SHIFT       %d\n", CURVE_SHIFT);
+    for (uint8_t r = 2; r <= 6; ++r) {
+        printf("\nstatic const uint8_t mouseCurve%u[256] = {  // x %u/3\n", r, r);
+        for (unsigned v = 0; v < 256; ++v) {
+            if (v % 16 == 0)
+                printf("   ");
+            printf(" 0x%02x,", entry(v, r));
+            if (v % 16 == 15)
+                printf("\n");
+        }
+        printf("};\n");
+    }
+    printf("\n#endif  // #ifndef MOUSE_CURVE_H\n");
+}
+
+static const uint8_t* curveFor(uint8_t r)
+{
+    switch (r) {
+    case 2:
+        return mouseCurve2;
+    case 3:
+        return mouseCurve3;
+    case 4:
+        return mouseCurve4;
+    case 5:
+        return mouseCurve5;
+    default:
+        return mouseCurve6;
+    }
+}
+
+static void load(const char* path)
+{
+    FILE* file = fopen(path, "r");
+    unsigned x, y;
+    char line[128];
+
+    if (!file) {
+        perror(path);
+        exit(EXIT_FAILURE);
+    }
+    while (fgets(line, sizeof line, file) && count < SAMPLES_MAX) {
+        if (sscanf(line, "%u %u", &x, &y) == 2 && x < 256 && y < 256) {
+            samples[count][0] = x;
+            samples[count][1] = y;
+            ++count;
+        }
+    }
+    fclose(file);
+}
+
+static double seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char* argv[])
+{
+    if (1 < argc && !strcmp(argv[1], "-g")) {
+        generate();
+        return EXIT_SUCCESS;
+    }
+    for (int i = 1; i < argc; ++i)
+        load(argv[i]);
+    if (!count) {
+        for (unsigned x = 0; x < 256; ++x) {
+            samples[count][0] = x;
+            samples[count][1] = 255 - x;
+            ++count;
+        }
+    }
+
+    // Check every sample against every centre the pad may settle on where
+    // the curve moves by whole counts.
+    unsigned mismatches = 0;
+    for (uint8_t res = 0; res <= PAD_SENSE_MAX; ++res) {
+        for (int aim = 0; aim < 2; ++aim) {
+            uint8_t r = aim ? aimTable[res] : normalTable[res];
+            const uint8_t* curve = curveFor(r);
+            for (unsigned c = 0; c < 256; ++c) {
+                for (unsigned i = 0; i < count; ++i) {
+                    for (int axis = 0; axis < 2; ++axis) {
+                        uint8_t raw = samples[i][axis];
+                        int16_t acc = 0;
+                        if (curve[(c <= raw) ? raw - c : c - raw] & MOUSE_CURVE_FRACTION)
+                            continue;
+                        if (trimReference(raw, c, r, 0) != trimTable(raw, c, curve, &acc, 0))
+                            ++mismatches;
+                    }
+                }
+            }
+        }
+    }
+
+    // Hold each fractional offset and compare the distance and the
+    // deviation from uniform motion.
+    double devReference = 0, devTable[SHIFT_MAX + 1] = { 0 };
+    unsigned held = 0;
+    for (uint8_t r = 2; r <= 6; ++r) {
+        const uint8_t* curve = curveFor(r);
+        for (unsigned v = 0; v < 128; ++v) {
+            if (!(curve[v] & MOUSE_CURVE_FRACTION))
+                continue;
+            int ref = 0;
+            for (unsigned t = 0; t < HOLD; ++t)
+                ref += trimReference(128 + v, 128, r, t % (TICK_MAX + 1));
+            double speed = (double) ref / HOLD;    // per nominal sample
+            int pos = 0;
+            for (unsigned t = 0; t < HOLD; ++t) {
+                pos += trimReference(128 + v, 128, r, t % (TICK_MAX + 1));
+                devReference += (pos - speed * (t + 1)) * (pos - speed * (t + 1));
+            }
+            for (uint8_t shift = 0; shift <= SHIFT_MAX; ++shift) {
+                int16_t acc = 0;
+                pos = 0;
+                for (unsigned t = 0; t < (HOLD << shift); ++t) {
+                    pos += trimTable(128 + v, 128, curve, &acc, shift);
+                    double ideal = speed * (t + 1) / (1u << shift);
+                    if (!((t + 1) & ((1u << shift) - 1)))
+                        devTable[shift] += (pos - ideal) * (pos - ideal);
+                }
+                if (abs(pos - ref) > 1)
+                    ++mismatches;
+            }
+            ++held;
+        }
+    }
+
+    // Time both with the pad centred as in use.
+    volatile int sink = 0;
+    uint8_t tick = 0;
+    int16_t accX = 0, accY = 0;
+    double t0 = seconds();
+    for (int round = 0; round < ROUNDS; ++round) {
+        for (uint8_t res = 0; res <= PAD_SENSE_MAX; ++res) {
+            for (unsigned i = 0; i < count; ++i) {
+                sink += trimReference(samples[i][0], 128, normalTable[res], tick);
+                sink += trimReference(samples[i][1], 128, normalTable[res], tick);
+                if (TICK_MAX < ++tick)
+                    tick = 0;
+            }
+        }
+    }
+    double t1 = seconds();
+    for (int round = 0; round < ROUNDS; ++round) {
+        for (uint8_t res = 0; res <= PAD_SENSE_MAX; ++res) {
+            const uint8_t* curve = curveFor(normalTable[res]);
+            for (unsigned i = 0; i < count; ++i) {
+                sink += trimTable(samples[i][0], 128, curve, &accX, 0);
+                sink += trimTable(samples[i][1], 128, curve, &accY, 0);
+            }
+        }
+    }
+    double t2 = seconds();
+    double n = (double) ROUNDS * (PAD_SENSE_MAX + 1) * count;
+
+    printf("samples: %u, mismatches: %u\n", count, mismatches);
+    printf("reference: %.1f ns/sample, table: %.1f ns/sample\n",
+           (t1 - t0) / n * 1e9, (t2 - t1) / n * 1e9);
+    if (held) {
+        printf("rms deviation from uniform motion [count]: reference %.3f", sqrt(devReference / held / HOLD));
+        for (uint8_t shift = 0; shift <= SHIFT_MAX; ++shift)
+            printf(", x%u rate %.3f", 1u << shift, sqrt(devTable[shift] / held / HOLD));
+        printf("\n");
+    }
+    return mismatches ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,170 @@
+/*
+ * Copyright 2026 Esrille Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/*
+ * powermodel - battery life estimate from the NISSE power state counters
+ *
+ * Reads the "PWR a/s/z/x S LED d1/d2/d3 S" line that the about command
+ * types in the BLE mode, and turns the time spent in each state into the
+ * average current draw and the expected battery life. The line may be
+ * given as arguments or on the standard input:
+ *
+ *   powermodel PWR 12/3/2391/1120S LED 0/0/41S
+ *
+ * Note the active time includes the SPI time. The default currents are
+ * rough figures for the PIC18F47J53 at 48 MHz plus the nRF51 module; use
+ * the options to replace them with measured values.
+ *
+ * Build:
+ *
+ *   cc -O2 -o powermodel tools/powermodel/powermodel.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+enum {
+    STATE_ACTIVE,
+    STATE_SPI,
+    STATE_SLEEPING,
+    STATE_SUSPENDED,
+    STATE_LED1,
+    STATE_LED2,
+    STATE_LED3,
+    STATE_COUNT
+};
+
+static const char* names[STATE_COUNT] = {
+    "active", "spi", "sleeping", "suspended", "led1", "led2", "led3"
+};
+
+// Current draw in each state [mA]
+static double current[STATE_COUNT] = {
+    12.0,   // active: CPU at 48 MHz scanning the matrix
+    13.5,   // spi: CPU plus SPI2 plus the module busy with the report
+    0.25,   // sleeping: CPU asleep between ticks, module connected
+    0.02,   // suspended: CPU asleep until a key press, module suspended
+    2.0, 2.0, 2.0
+};
+
+static double capacity = 2000.0;    // two AA cells [mAh]
+
+static void usage(void)
+{
+    fprintf(stderr,
+            "usage: powermodel [-a mA] [-s mA] [-z mA] [-x mA] [-l mA] [-c mAh] [PWR line]\n"
+            "  -a  current while active (default %.2f)\n"
+            "  -s  current during SPI transactions (default %.2f)\n"
+            "  -z  current while sleeping between ticks (default %.2f)\n"
+            "  -x  current while suspended (default %.2f)\n"
+            "  -l  current of each LED (default %.2f)\n"
+            "  -c  battery capacity (default %.0f)\n",
+            current[STATE_ACTIVE], current[STATE_SPI], current[STATE_SLEEPING],
+            current[STATE_SUSPENDED], current[STATE_LED1], capacity);
+    exit(EXIT_FAILURE);
+}
+
+// Parses "PWR a/s/z/xS LED d1/d2/d3S" into seconds per state.
+static int parse(const char* line, double* sec)
+{
+    const char* p = strstr(line, "PWR");
+    if (!p)
+        return -1;
+    unsigned long v[STATE_COUNT];
+    if (sscanf(p, "PWR %lu/%lu/%lu/%luS LED %lu/%lu/%luS",
+               &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &v[6]) != STATE_COUNT)
+        return -1;
+    for (int i = 0; i < STATE_COUNT; ++i)
+        sec[i] = v[i];
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    int opt;
+    while ((opt = getopt(argc, argv, "a:s:z:x:l:c:h")) != -1) {
+        switch (opt) {
+        case 'a':
+            current[STATE_ACTIVE] = atof(optarg);
+            break;
+        case 's':
+            current[STATE_SPI] = atof(optarg);
+            break;
+        case 'z':
+            current[STATE_SLEEPING] = atof(optarg);
+            break;
+        case 'x':
+            current[STATE_SUSPENDED] = atof(optarg);
+            break;
+        case 'l':
+            current[STATE_LED1] = current[STATE_LED2] = current[STATE_LED3] = atof(optarg);
+            break;
+        case 'c':
+            capacity = atof(optarg);
+            break;
+        default:
+            usage();
+            break;
+        }
+    }
+
+    char line[256];
+    line[0] = '\0';
+    if (optind < argc) {
+        for (int i = optind; i < argc; ++i) {
+            strncat(line, argv[i], sizeof line - strlen(line) - 2);
+            strcat(line, " ");
+        }
+    } else if (!fgets(line, sizeof line, stdin)) {
+        usage();
+    }
+
+    double sec[STATE_COUNT];
+    if (parse(line, sec) < 0) {
+        fprintf(stderr, "powermodel: no PWR line found\n");
+        return EXIT_FAILURE;
+    }
+
+    // The active time includes the SPI time.
+    if (sec[STATE_ACTIVE] < sec[STATE_SPI])
+        sec[STATE_ACTIVE] = sec[STATE_SPI];
+    sec[STATE_ACTIVE] -= sec[STATE_SPI];
+
+    double total = sec[STATE_ACTIVE] + sec[STATE_SPI] + sec[STATE_SLEEPING] + sec[STATE_SUSPENDED];
+    if (total <= 0.0) {
+        fprintf(stderr, "powermodel: no time recorded\n");
+        return EXIT_FAILURE;
+    }
+
+    double charge = 0.0;
+    for (int i = 0; i < STATE_COUNT; ++i)
+        charge += sec[i] * current[i];
+    double average = charge / total;
+
+    printf("%-10s %10s %7s %8s %7s\n", "state", "time [s]", "share", "mA", "of avg");
+    for (int i = 0; i < STATE_COUNT; ++i) {
+        double share = sec[i] / total * 100.0;
+        double part = sec[i] * current[i] / total;
+        printf("%-10s %10.0f %6.1f%% %8.3f %6.1f%%\n",
+               names[i], sec[i], share, part, average > 0.0 ? part / average * 100.0 : 0.0);
+    }
+    printf("average %.3f mA, battery life %.0f h (%.1f days) with %.0f mAh\n",
+           average, capacity / average, capacity / average / 24.0, capacity);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,309 @@
+/*
+ * Copyright 2026 Esrille Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/*
+ * telemetry - read the keyboard statistics over the telemetry interface
+ *
+ * The USB firmware exposes a vendor defined HID interface with two FEATURE
+ * reports (see app_device_telemetry.c): the counters of the key scan and
+ * the report queue with the time the keyboard took to start up, and the
+ * time from a key scan to the IN token that took its report. This tool reads them through hidraw, so nothing is typed
+ * into the focused window:
+ *
+ *   telemetry [-j] [-i sec] [-n count] [/dev/hidrawN]
+ *
+ * samples the reports every -i seconds (1 by default) -n times (forever by
+ * default) and prints the scan and report rates over each interval. -j
+ * prints one JSON object per sample instead, for collecting the data from
+ * many keyboards. Without a device, the first hidraw device with the
+ * telemetry report descriptor is used; it usually has to be readable by
+ * the user, e.g., through a udev rule.
+ *
+ * Build in firmware/:
+ *
+ *   cc -O2 -o telemetry tools/telemetry/telemetry.c
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <linux/hidraw.h>
+#include <sys/ioctl.h>
+
+#define TELEMETRY_VERSION           2
+#define TELEMETRY_REPORT_COUNTERS   1
+#define TELEMETRY_REPORT_LATENCY    2
+
+#define LATENCY_BUCKETS     8
+#define HIDRAW_MAX          64
+
+typedef struct {
+    uint8_t version;
+    uint32_t scans;
+    uint32_t reports;
+    uint16_t ghosts;
+    uint16_t bounces;
+    uint8_t macroDepth;
+    uint8_t macroMax;
+    uint16_t hosRetries;
+    uint16_t merges;
+    uint16_t stalls;
+    uint16_t attach;        // from reset to each step of the start-up [msec]
+    uint16_t configured;
+    uint16_t firstKey;
+} Counters;
+
+typedef struct {
+    uint16_t scan;
+    uint16_t min;
+    uint16_t avg;
+    uint16_t max;
+    uint16_t latency[LATENCY_BUCKETS];
+} Latency;
+
+// The first bytes of the report descriptor of the telemetry interface
+static const uint8_t signature[] = {
+    0x06, 0x00, 0xFF,   // Usage Page (Vendor Defined 0xFF00)
+    0x09, 0x01,         // Usage (1)
+    0xA1, 0x01,         // Collection (Application)
+};
+
+static const char* const bucketNames[LATENCY_BUCKETS] = {
+    "<1", "<2", "<4", "<8", "<16", "<32", "<64", ">=64"
+};
+
+static uint16_t get16(const uint8_t* p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t get32(const uint8_t* p)
+{
+    return get16(p) | ((uint32_t) get16(p + 2) << 16);
+}
+
+static bool isTelemetry(int fd)
+{
+    struct hidraw_report_descriptor desc;
+
+    if (ioctl(fd, HIDIOCGRDESCSIZE, &desc.size) < 0 || desc.size < sizeof signature)
+        return false;
+    if (ioctl(fd, HIDIOCGRDESC, &desc) < 0)
+        return false;
+    return memcmp(desc.value, signature, sizeof signature) == 0;
+}
+
+static int openTelemetry(const char* path)
+{
+    char name[32];
+    int fd;
+
+    if (path) {
+        fd = open(path, O_RDWR);
+        if (fd < 0) {
+            perror(path);
+            return -1;
+        }
+        if (!isTelemetry(fd)) {
+            fprintf(stderr, "%s: not the keyboard telemetry interface\n", path);
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+    for (int i = 0; i < HIDRAW_MAX; ++i) {
+        snprintf(name, sizeof name, "/dev/hidraw%d", i);
+        fd = open(name, O_RDWR);
+        if (fd < 0)
+            continue;
+        if (isTelemetry(fd))
+            return fd;
+        close(fd);
+    }
+    fprintf(stderr, "telemetry: no keyboard telemetry interface found\n");
+    return -1;
+}
+
+static int getFeature(int fd, uint8_t id, uint8_t* buf, size_t len)
+{
+    int n;
+
+    buf[0] = id;
+    n = ioctl(fd, HIDIOCGFEATURE(len), buf);
+    if (n < 0) {
+        perror("HIDIOCGFEATURE");
+        return -1;
+    }
+    if ((size_t) n < len || buf[0] != id) {
+        fprintf(stderr, "telemetry: short report %u (%d bytes)\n", id, n);
+        return -1;
+    }
+    return 0;
+}
+
+static int readCounters(int fd, Counters* c)
+{
+    uint8_t buf[28];
+
+    if (getFeature(fd, TELEMETRY_REPORT_COUNTERS, buf, sizeof buf) < 0)
+        return -1;
+    c->version = buf[1];
+    c->scans = get32(buf + 2);
+    c->reports = get32(buf + 6);
+    c->ghosts = get16(buf + 10);
+    c->bounces = get16(buf + 12);
+    c->macroDepth = buf[14];
+    c->macroMax = buf[15];
+    c->hosRetries = get16(buf + 16);
+    c->merges = get16(buf + 18);
+    c->stalls = get16(buf + 20);
+    c->attach = get16(buf + 22);
+    c->configured = get16(buf + 24);
+    c->firstKey = get16(buf + 26);
+    if (c->version != TELEMETRY_VERSION) {
+        fprintf(stderr, "telemetry: unknown version %u\n", c->version);
+        return -1;
+    }
+    return 0;
+}
+
+static int readLatency(int fd, Latency* l)
+{
+    uint8_t buf[25];
+
+    if (getFeature(fd, TELEMETRY_REPORT_LATENCY, buf, sizeof buf) < 0)
+        return -1;
+    l->scan = get16(buf + 1);
+    l->min = get16(buf + 3);
+    l->avg = get16(buf + 5);
+    l->max = get16(buf + 7);
+    for (int i = 0; i < LATENCY_BUCKETS; ++i)
+        l->latency[i] = get16(buf + 9 + 2 * i);
+    return 0;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void printText(const Counters* c, const Latency* l, double scanRate, double reportRate)
+{
+    printf("scans %u (%.1f/s) reports %u (%.1f/s) merges %u stalls %u\n",
+           c->scans, scanRate, c->reports, reportRate, c->merges, c->stalls);
+    printf("ghosts %u bounces %u macro %u/%u hos retries %u\n",
+           c->ghosts, c->bounces, c->macroDepth, c->macroMax, c->hosRetries);
+    printf("startup attach %u configured %u first key %u msec (0: not yet)\n",
+           c->attach, c->configured, c->firstKey);
+    printf("scan %u usec, scan to IN min/avg/max %u/%u/%u usec\n",
+           l->scan, l->min, l->avg, l->max);
+    printf("latency [msec]");
+    for (int i = 0; i < LATENCY_BUCKETS; ++i)
+        printf(" %s:%u", bucketNames[i], l->latency[i]);
+    printf("\n\n");
+}
+
+static void printJSON(const Counters* c, const Latency* l, double scanRate, double reportRate)
+{
+    printf("{\"time\":%ld,\"scans\":%u,\"scan_rate\":%.1f,\"reports\":%u,\"report_rate\":%.1f,"
+           "\"merges\":%u,\"stalls\":%u,\"ghosts\":%u,\"bounces\":%u,"
+           "\"macro_depth\":%u,\"macro_max\":%u,\"hos_retries\":%u,"
+           "\"attach_ms\":%u,\"configured_ms\":%u,\"first_key_ms\":%u,"
+           "\"scan_us\":%u,\"latency_min_us\":%u,\"latency_avg_us\":%u,\"latency_max_us\":%u,"
+           "\"latency_ms\":[",
+           (long) time(NULL), c->scans, scanRate, c->reports, reportRate,
+           c->merges, c->stalls, c->ghosts, c->bounces,
+           c->macroDepth, c->macroMax, c->hosRetries,
+           c->attach, c->configured, c->firstKey,
+           l->scan, l->min, l->avg, l->max);
+    for (int i = 0; i < LATENCY_BUCKETS; ++i)
+        printf("%s%u", i ? "," : "", l->latency[i]);
+    printf("]}\n");
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "usage: telemetry [-j] [-i sec] [-n count] [/dev/hidrawN]\n");
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char* argv[])
+{
+    bool json = false;
+    double interval = 1.0;
+    long count = -1;
+    Counters last, c;
+    Latency l;
+    double lastTime, t;
+    int opt;
+    int fd;
+
+    while ((opt = getopt(argc, argv, "ji:n:")) != -1) {
+        switch (opt) {
+        case 'j':
+            json = true;
+            break;
+        case 'i':
+            interval = atof(optarg);
+            if (interval <= 0)
+                usage();
+            break;
+        case 'n':
+            count = atol(optarg);
+            break;
+        default:
+            usage();
+        }
+    }
+    if (argc - optind > 1)
+        usage();
+
+    fd = openTelemetry(optind < argc ? argv[optind] : NULL);
+    if (fd < 0)
+        return EXIT_FAILURE;
+    if (readCounters(fd, &last) < 0)
+        return EXIT_FAILURE;
+    lastTime = now();
+    while (count < 0 || 0 < count--) {
+        usleep(interval * 1000000);
+        if (readCounters(fd, &c) < 0 || readLatency(fd, &l) < 0)
+            return EXIT_FAILURE;
+        t = now();
+        // The counters are unsigned and wrap around together.
+        double scanRate = (uint32_t) (c.scans - last.scans) / (t - lastTime);
+        double reportRate = (uint32_t) (c.reports - last.reports) / (t - lastTime);
+        if (json)
+            printJSON(&c, &l, scanRate, reportRate);
+        else
+            printText(&c, &l, scanRate, reportRate);
+        fflush(stdout);
+        last = c;
+        lastTime = t;
+    }
+    close(fd);
+    return EXIT_SUCCESS;
+}